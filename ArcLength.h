@@ -0,0 +1,121 @@
+#pragma once
+#include "BasicGeometry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+*	Queries on polyline by distance travelled along it,
+*	table holds arc length at every point of polyline
+*/
+namespace ArcLength
+{
+	using Table = std::vector<float>;
+
+	struct Sample
+	{
+		Point point = {};
+		glm::vec3 tangent = {};
+		// index of point segment starts with
+		uint32_t segment = 0;
+	};
+
+	// part of polyline between two distances, nothing is copied
+	struct Span
+	{
+		Point start = {};
+		Point end = {};
+		// whole points inside, first to one past last
+		uint32_t firstPoint = 0;
+		uint32_t lastPoint = 0;
+	};
+
+	inline Table createTable(const Points& points)
+	{
+		Table table(points.size());
+		for (uint32_t index = 1; index < points.size(); ++index)
+			table[index] = table[index - 1] + glm::length(points[index] - points[index - 1]);
+
+		return table;
+	}
+
+	inline float length(const Table& table)
+	{
+		return table.empty() ? 0.0f : table.back();
+	}
+
+	// table needs at least two points
+	inline uint32_t segmentAt(const Table& table, float distance)
+	{
+		const auto upper = std::upper_bound(std::begin(table) + 1, std::end(table) - 1, distance);
+
+		return static_cast<uint32_t>(upper - std::begin(table)) - 1;
+	}
+
+	// moves segment forward only, cheap when distance grows slowly
+	inline uint32_t advanceSegment(const Table& table, float distance, uint32_t segment)
+	{
+		while (segment + 2 < table.size() && table[segment + 1] <= distance)
+			++segment;
+
+		return segment;
+	}
+
+	inline Sample sampleOnSegment(const Points& points, const Table& table, float distance, uint32_t segment)
+	{
+		const auto& segmentStart = points[segment];
+		const auto& segmentEnd = points[segment + 1];
+		const float segmentLength = table[segment + 1] - table[segment];
+
+		Sample sample;
+		sample.segment = segment;
+		if (segmentLength > 0.0f)
+		{
+			const float progress = glm::clamp((distance - table[segment]) / segmentLength, 0.0f, 1.0f);
+
+			sample.point = segmentStart + (segmentEnd - segmentStart) * progress;
+			sample.tangent = (segmentEnd - segmentStart) / segmentLength;
+		}
+		else
+		{
+			sample.point = segmentEnd;
+		}
+
+		return sample;
+	}
+
+	inline Sample sampleAt(const Points& points, const Table& table, float distance)
+	{
+		return sampleOnSegment(points, table, distance, segmentAt(table, distance));
+	}
+
+	inline Span spanBetween(const Points& points, const Table& table, float from, float to)
+	{
+		const auto startSample = sampleAt(points, table, from);
+		const auto endSample = sampleAt(points, table, to);
+
+		Span span;
+		span.start = startSample.point;
+		span.end = endSample.point;
+		span.firstPoint = startSample.segment + 1;
+		span.lastPoint = std::max(endSample.segment + 1, span.firstPoint);
+
+		return span;
+	}
+
+	// function(segmentStart, segmentEnd) for every segment of span, stops when it returns true
+	template<class Function> bool anyOfSegments(const Points& points, const Span& span, Function&& function)
+	{
+		Point segmentStart = span.start;
+		for (uint32_t index = span.firstPoint; index < span.lastPoint; ++index)
+		{
+			if (function(segmentStart, points[index]))
+				return true;
+
+			segmentStart = points[index];
+		}
+
+		return function(segmentStart, span.end);
+	}
+}
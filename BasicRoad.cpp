@@ -27,6 +27,7 @@ BasicRoad::BasicRoad(BasicRoad&& move)
 BasicRoad& BasicRoad::operator=(const BasicRoad& copy)
 {
 	SimulationObject::operator=(copy);
+	m_lanesDirty = true;
 
 	disconnectAll();
 	copy.copyConnections(this);
@@ -40,6 +41,7 @@ BasicRoad& BasicRoad::operator=(const BasicRoad& copy)
 BasicRoad& BasicRoad::operator=(BasicRoad&& move)
 {
 	SimulationObject::operator=(std::move(move));
+	m_lanesDirty = true;
 
 	disconnectAll();
 
@@ -110,6 +112,10 @@ BasicRoad* BasicRoad::findConnectedRoad(Point point) const
 
 void BasicRoad::connect(BasicRoad* connectionRoad, Point connectionPoint)
 {
+	// lanes point to connected roads
+	markLanesDirty();
+	connectionRoad->markLanesDirty();
+
 	Connection connection;
 	connection.point = connectionPoint;
 	connection.connected = connectionRoad;
@@ -143,6 +149,9 @@ void BasicRoad::dismissConnection(Connection connection)
 	auto& thisConnection = getConnection(connection);
 	auto& otherConnection = thisConnection.connected->getConnection(this, connection.point);
 
+	markLanesDirty();
+	connection.connected->markLanesDirty();
+
 	//erase from ours
 	m_connections.erase(std::find(std::begin(m_connections), std::end(m_connections), thisConnection));
 
@@ -159,6 +168,25 @@ void BasicRoad::disconnectAll()
 	}
 }
 
+void BasicRoad::updateLanes()
+{
+	if (!m_lanesDirty)
+		return;
+
+	createLanes();
+	m_lanesDirty = false;
+}
+
+void BasicRoad::markLanesDirty()
+{
+	m_lanesDirty = true;
+}
+
+bool BasicRoad::areLanesDirty() const
+{
+	return m_lanesDirty;
+}
+
 Lane BasicRoad::getClosestLane(Point pt) const
 {
 	auto closestTraiPoint = [](const Trail& trail, Point pt)
@@ -280,6 +308,22 @@ std::vector<Lane> BasicRoad::getAllLanesConnectingTwoRoads(
 	return subsequentLanes;
 }
 
+void Lane::setPoints(Points newPoints)
+{
+	points = std::move(newPoints);
+	distances = ArcLength::createTable(points);
+}
+
+float Lane::length() const
+{
+	return ArcLength::length(distances);
+}
+
+ArcLength::Sample Lane::sampleAt(float distance) const
+{
+	return ArcLength::sampleAt(points, distances, distance);
+}
+
 bool Lane::leadsToLane(const Lane& leadsToLane) const
 {
 	return approxSamePoints(points.back(), leadsToLane.points.front());
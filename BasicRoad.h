@@ -2,6 +2,7 @@
 #include "SimulationObject.h"
 #include "SegmentedShape.h"
 #include "Mesh.h"
+#include "ArcLength.h"
 
 #include <map>
 #include <glm/glm.hpp>
@@ -9,12 +10,18 @@
 class BasicRoad;
 struct Lane
 {
+	// set through setPoints, so distances stay in sync
 	Points points;
+	ArcLength::Table distances;
 	BasicRoad* connectsTo = nullptr;
 	BasicRoad* connectsFrom = nullptr;
 	enum class Side { LEFT, RIGHT };
 	Side side = {};
 
+	void setPoints(Points newPoints);
+	float length() const;
+	ArcLength::Sample sampleAt(float distance) const;
+
 	bool leadsToLane(const Lane& leadsToLane) const;
 	bool empty() const;
 	friend bool operator==(const Lane& lhs, const Lane& rhs);
@@ -87,6 +94,10 @@ public:
 	virtual Shape::AxisPoint getAxisPoint(Point pointOnRoad) const = 0;
 
 	virtual void createLanes() = 0;
+	// lanes are kept between runs, recreated only when marked
+	void updateLanes();
+	void markLanesDirty();
+	bool areLanesDirty() const;
 	virtual bool canSwitchLanes() const = 0;
 	Lane getClosestLane(Point pt) const;
 	std::unordered_map<Lane::Side, std::vector<Lane>> getAllLanes()const;
@@ -112,6 +123,8 @@ protected:
 
 	std::vector<Connection> m_connections;
 	std::unordered_map<Lane::Side, std::vector<Lane>> m_lanes;
+	// copies dont take lanes, so they start dirty
+	bool m_lanesDirty = true;
 
 // lanes
 	virtual Mesh createLineMesh() = 0;
@@ -4,7 +4,7 @@
 #include <random>
 #include <chrono>
 
-#include "SimpleCar.h"
+#include "GlobalObjects.h"
 #include "LineManipulator.h"
 #include "EarcutAdaptation.h"
 
@@ -75,6 +75,7 @@ void CarSpawner::createLanes()
 	const auto axisPoints = m_shape.getAxisPoints();
 	const auto shapeEndPoint = m_shape.getHead();
 
+	m_lanes.clear();
 	// right paths
 	for(const auto& path : outcomingLanes)
 	{
@@ -88,7 +89,7 @@ void CarSpawner::createLanes()
 		path.connectsFrom = nullptr;
 		path.connectsTo = &connectedRoad;
 		path.side = Lane::Side::RIGHT;
-		path.points = pathPoints;
+		path.setPoints(pathPoints);
 
 		m_lanes[Lane::Side::RIGHT].emplace_back(path);
 
@@ -108,7 +109,7 @@ void CarSpawner::createLanes()
 		path.connectsFrom = &connectedRoad;
 		path.connectsTo = nullptr;
 		path.side = Lane::Side::LEFT;
-		path.points = pathPoints;
+		path.setPoints(pathPoints);
 
 		m_lanes[Lane::Side::LEFT].emplace_back(path);
 	}
@@ -180,28 +181,11 @@ void CarSpawner::construct(Road* road, Point connectPoint)
 void CarSpawner::disable()
 {
 	m_disabled = true;
-	m_spawnedCars = {};
 }
 
 void CarSpawner::enable()
 {
 	m_disabled = false;
-	m_spawnedCars = {};
-}
-
-void CarSpawner::initializePossiblePaths(const std::vector<CarSpawner>& allSpawners)
-{
-	m_routesToSpawner.clear();
-	for (const auto& spawner : allSpawners)
-	{
-		// dont make with self
-		if (&spawner == this)
-			continue;
-
-		auto routes = PathFinding::createRoadRoutes(*this, spawner);
-		if(!routes.empty())
-			m_routesToSpawner[&spawner] = routes;
-	}
 }
 
 void CarSpawner::spawnCar()
@@ -211,40 +195,10 @@ void CarSpawner::spawnCar()
 		std::cout << "No lanes generated for spawner\n";
 		return;
 	}
-	if (!m_routesToSpawner.empty())
+	static std::mt19937 engine(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	if (const auto* route = App::routeTable.getRandomRoute(this, engine))
 	{
-		const auto& [spawner, routes] = *m_routesToSpawner.begin();
-		if (spawner->m_lanes.empty())
-		{
-			std::cout << "No lanes generated for other spawner\n";
-			return;
-		}
-
-		if (!routes.empty())
-		{
-			auto route = routes.front();
-
-			auto randomLane = [](const std::vector<Lane>& lanes) -> Lane
-			{
-				int maxNum = lanes.size() - 1;
-
-				static std::mt19937 engine(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-
-				std::uniform_int_distribution randomDistributor(0, maxNum);
-
-				return lanes[randomDistributor(engine)];
-			};
-
-			Lane startLane = randomLane(m_lanes[Lane::Side::RIGHT]);
-			// left since we enter from opposite direction
-			Lane endLane = randomLane(spawner->m_lanes.find(Lane::Side::LEFT)->second);
-
-			auto travellSEgments = PathFinding::findLaneOnRoute(route, startLane, endLane);
-
-			auto& car = m_spawnedCars.emplace_back(SimpleCar());
-			car.drive(travellSEgments);
-			car.setActive(true);
-		}
+		App::vehicleEngine.spawnVehicle(*route);
 	}
 	std::cout << "\n";
 }
@@ -2,7 +2,6 @@
 #include "BasicRoad.h"
 #include "SegmentedShape.h"
 #include "RoadPathFinder.h"
-#include "SimpleCar.h"
 
 class Road;
 class CarSpawner :
@@ -31,7 +30,6 @@ public:
 	void disable();
 	void enable();
 
-	void initializePossiblePaths(const std::vector<CarSpawner>& allSpawners);
 	void spawnCar();
 
 	bool canReceiveCars() const;
@@ -45,9 +43,5 @@ private:
 	bool m_disabled;
 	bool m_canSpawnCars = true;
 	bool m_canReceiveCars = true;
-
-	std::vector<SimpleCar> m_spawnedCars;
-
-	std::unordered_map<const CarSpawner*, PathFinding::RoadRoutes> m_routesToSpawner;
 };
 
@@ -84,14 +84,110 @@ bool Collider::circlesOverlay(const Circle& firstCircle, const Circle& secondCir
 	return circleDistances <= std::abs(r1 + r2);
 }
 
-Collider::Rectangle Collider::createRectangle(const Points& points)
+bool Collider::createRectangle(const Points& points, Rectangle& rectangle)
 {
-	return Rectangle();
+	if (points.size() != 4)
+		return false;
+
+	auto toXZ = [](const Point& point) { return glm::vec2(point.x, point.z); };
+	const glm::vec2 corners[4] = { toXZ(points[0]), toXZ(points[1]), toXZ(points[2]), toXZ(points[3]) };
+	const glm::vec2 firstSide = corners[1] - corners[0];
+	const glm::vec2 secondSide = corners[2] - corners[1];
+
+	const float length = glm::length(firstSide);
+	const float width = glm::length(secondSide);
+	if (length == 0.0f || width == 0.0f)
+		return false;
+
+	// opposite sides same and first two perpendicular
+	const float tolerance = (length + width) * 0.001f;
+	if (glm::length(corners[3] - corners[2] + firstSide) > tolerance ||
+		glm::length(corners[0] - corners[3] + secondSide) > tolerance ||
+		std::abs(glm::dot(firstSide, secondSide)) > tolerance * (length + width))
+		return false;
+
+	rectangle.centre = (corners[0] + corners[1] + corners[2] + corners[3]) / 4.0f;
+	rectangle.axis = firstSide / length;
+	rectangle.halfSizes = glm::vec2(length, width) / 2.0f;
+
+	return true;
 }
 
-bool Collider::rectanglesOverlay(const Rectangle& firstCircle, const Rectangle& secondCircle)
+Points Collider::getRectangleCorners(const Rectangle& rectangle)
 {
-	return false;
+	const glm::vec2 side = rectangle.axis * rectangle.halfSizes.x;
+	const glm::vec2 otherSide = glm::vec2(-rectangle.axis.y, rectangle.axis.x) * rectangle.halfSizes.y;
+
+	auto toPoint = [](const glm::vec2& point) { return Point(point.x, 0.0f, point.y); };
+	return {
+		toPoint(rectangle.centre - side - otherSide),
+		toPoint(rectangle.centre + side - otherSide),
+		toPoint(rectangle.centre + side + otherSide),
+		toPoint(rectangle.centre - side + otherSide) };
+}
+
+bool Collider::rectanglesOverlay(const Rectangle& firstRectangle, const Rectangle& secondRectangle)
+{
+	RectangleBatch batch;
+	batch.push(secondRectangle);
+
+	bool overlays[RectangleBatch::capacity];
+	rectanglesOverlay(firstRectangle, batch, overlays);
+
+	return overlays[0];
+}
+
+bool Collider::rectangleContains(const Rectangle& rectangle, const Point& point)
+{
+	const glm::vec2 distance = glm::vec2(point.x, point.z) - rectangle.centre;
+	const glm::vec2 perpendicular = glm::vec2(-rectangle.axis.y, rectangle.axis.x);
+
+	return std::abs(glm::dot(distance, rectangle.axis)) <= rectangle.halfSizes.x &&
+		std::abs(glm::dot(distance, perpendicular)) <= rectangle.halfSizes.y;
+}
+
+void Collider::RectangleBatch::push(const Rectangle& rectangle)
+{
+	centreX[count] = rectangle.centre.x;
+	centreZ[count] = rectangle.centre.y;
+	axisX[count] = rectangle.axis.x;
+	axisZ[count] = rectangle.axis.y;
+	halfLength[count] = rectangle.halfSizes.x;
+	halfWidth[count] = rectangle.halfSizes.y;
+	++count;
+}
+
+void Collider::rectanglesOverlay(const Rectangle& rectangle, const RectangleBatch& batch, bool* overlays)
+{
+	const float axisX = rectangle.axis.x;
+	const float axisZ = rectangle.axis.y;
+	const float halfLength = rectangle.halfSizes.x;
+	const float halfWidth = rectangle.halfSizes.y;
+
+	// whole capacity, fixed count lets compiler drop the loop for vector code
+	for (uint32_t index = 0; index < RectangleBatch::capacity; ++index)
+	{
+		const float distanceX = batch.centreX[index] - rectangle.centre.x;
+		const float distanceZ = batch.centreZ[index] - rectangle.centre.y;
+
+		// cos and sin of angle between axes, perpendiculars turn the same
+		const float cosine = std::abs(axisX * batch.axisX[index] + axisZ * batch.axisZ[index]);
+		const float sine = std::abs(axisX * batch.axisZ[index] - axisZ * batch.axisX[index]);
+
+		// distance of centres against sum of half projections on each of four sides
+		const float alongAxis = std::abs(distanceX * axisX + distanceZ * axisZ);
+		const float alongPerpendicular = std::abs(distanceZ * axisX - distanceX * axisZ);
+		const float alongOtherAxis = std::abs(distanceX * batch.axisX[index] + distanceZ * batch.axisZ[index]);
+		const float alongOtherPerpendicular = std::abs(distanceZ * batch.axisX[index] - distanceX * batch.axisZ[index]);
+
+		const bool separated =
+			(alongAxis > halfLength + batch.halfLength[index] * cosine + batch.halfWidth[index] * sine) |
+			(alongPerpendicular > halfWidth + batch.halfLength[index] * sine + batch.halfWidth[index] * cosine) |
+			(alongOtherAxis > batch.halfLength[index] + halfLength * cosine + halfWidth * sine) |
+			(alongOtherPerpendicular > batch.halfWidth[index] + halfLength * sine + halfWidth * cosine);
+
+		overlays[index] = !separated;
+	}
 }
 
 /*
@@ -118,9 +214,13 @@ void Collider2D::set(const glm::vec3& newPosition, const glm::vec3& newRotation)
 void Collider2D::setBoundaries(const Points& newBoundaries)
 {
 	m_boundaries = newBoundaries;
+	m_isRectangle = Collider::createRectangle(m_boundaries, m_rectangle);
+	// turning and moving keeps it closed and corrected
+	m_localBoundaries = m_isRectangle ? CL::PolygonXZ() : Collision::details::createXZPolygonFromPoints(m_boundaries);
+	m_collisionBoundaries = m_localBoundaries;
 
 	setupCircle();
-	updateCollisionBoundaries();
+	m_worldShapeStale = true;
 }
 
 const Points& Collider2D::getBoundaries() const
@@ -138,6 +238,17 @@ glm::vec3 Collider2D::getRotation() const
 	return m_rotation;
 }
 
+Collider::BoundingBox Collider2D::getBoundingBox() const
+{
+	const auto& [centre, radius] = m_collisionCircle;
+
+	Collider::BoundingBox boundingBox;
+	boundingBox.min = glm::vec2(centre.x - radius, centre.z - radius);
+	boundingBox.max = glm::vec2(centre.x + radius, centre.z + radius);
+
+	return boundingBox;
+}
+
 
 bool Collider2D::canCollideWith(const Collider2D& other) const
 {
@@ -151,10 +262,19 @@ bool Collider2D::canCollideWith(uint32_t otherTag) const
 
 bool Collider2D::collidesWith(const Collider2D& other) const
 {
+	updateWorldShape();
+	other.updateWorldShape();
+
+	if (m_isRectangle && other.m_isRectangle)
+		return Collider::rectanglesOverlay(m_collisionRectangle, other.m_collisionRectangle);
+
 	// check before doing any calculations
 	if (Collider::circlesOverlay(m_collisionCircle, other.m_collisionCircle))
 	{
-		return Collision::polygonPolygon(m_collisionBoundaries, other.m_collisionBoundaries);
+		if (!m_isRectangle && !other.m_isRectangle)
+			return Collision::polygonPolygon(m_collisionBoundaries, other.m_collisionBoundaries);
+
+		return Collision::polygonPolygon(getCollisionPolygon(), other.getCollisionPolygon());
 	}
 
 	return false;
@@ -162,11 +282,20 @@ bool Collider2D::collidesWith(const Collider2D& other) const
 
 bool Collider2D::collidesWith(const Points& points) const
 {
-	return Collision::polygonPolygon(Collision::details::createXZPolygonFromPoints(points), m_collisionBoundaries);
+	updateWorldShape();
+	const auto polygon = Collision::details::createXZPolygonFromPoints(points);
+	if (m_isRectangle)
+		return Collision::polygonPolygon(polygon, getCollisionPolygon());
+
+	return Collision::polygonPolygon(polygon, m_collisionBoundaries);
 }
 
 bool Collider2D::collidesWith(const Point& point) const
 {
+	updateWorldShape();
+	if (m_isRectangle)
+		return Collider::rectangleContains(m_collisionRectangle, point);
+
 	return Collision::pointPolygon(Collision::details::createPointXZFromPoint(point), m_collisionBoundaries);
 }
 
@@ -186,6 +315,16 @@ void Collider2D::setTags(const std::vector<std::string>& newSelfTags, const std:
 	setOtherTags(newOtherTags);
 }
 
+void Collider2D::setSelfTags(uint32_t newSelfTags)
+{
+	m_tags = newSelfTags;
+}
+
+void Collider2D::setOtherTags(uint32_t newOtherTags)
+{
+	m_otherTags = newOtherTags;
+}
+
 void Collider2D::resetSelfTags()
 {
 	m_tags = 0;
@@ -217,18 +356,15 @@ bool Collider2D::isInCollison() const
 	return !m_currentlyInCollision.empty();
 }
 
-std::vector<SimulationObject*> Collider2D::getAllCollisionWith(std::string tagName) const
+std::vector<SimulationObject*> Collider2D::getAllCollisionWith(const std::string& tagName) const
 {
-	const auto checkTag = App::physics.getTagFlag(tagName);
-
-	std::set<SimulationObject*> collidedWith;
-	for (const auto& [collider, object] : m_currentlyInCollision)
-	{
-		if (collider->m_tags & checkTag)
-			collidedWith.emplace(object);
-	}
+	std::vector<SimulationObject*> collidedWith;
+	forEachCollisionWith(App::physics.getTagFlag(tagName), [&](SimulationObject* object)
+		{
+			collidedWith.push_back(object);
+		});
 
-	return std::vector(collidedWith.begin(), collidedWith.end());
+	return collidedWith;
 }
 
 void Collider2D::setPosition(const glm::vec3& newPosition)
@@ -238,18 +374,18 @@ void Collider2D::setPosition(const glm::vec3& newPosition)
 		m_position = newPosition;
 
 		updateCollisionCircle();
-		updateCollisionBoundaries();
+		m_worldShapeStale = true;
 	}
 }
 
 
 void Collider2D::setRotation(const glm::vec3& newRotation)
 {
-	if (newRotation != newRotation)
+	if (m_rotation != newRotation)
 	{
 		m_rotation = newRotation;
 
-		updateCollisionBoundaries();
+		m_worldShapeStale = true;
 	}
 }
 
@@ -266,48 +402,59 @@ void Collider2D::updateCollisionCircle()
 	m_collisionCircle.centre += m_position;
 }
 
-void Collider2D::updateCollisionBoundaries()
+void Collider2D::updateWorldShape() const
 {
-	std::vector<Point> transformedPoints(m_boundaries.size());
-	std::transform(std::begin(m_boundaries), std::end(m_boundaries), std::begin(transformedPoints),
-		[&](const Point& point)
-		{
-			auto rotatePointInXZPlane = [](glm::vec3 centre, float angle, Point point)
-			{
-				const float angleSin = glm::sin(angle);
-				const float angleCos = glm::cos(angle);
+	if (!m_worldShapeStale)
+		return;
+	m_worldShapeStale = false;
+
+	// turned around circle centre, then moved
+	const float angleSin = glm::sin(m_rotation.x);
+	const float angleCos = glm::cos(m_rotation.x);
+	const glm::vec2 centre = glm::vec2(m_circle.centre.x, m_circle.centre.z);
+	const glm::vec2 offset = centre + glm::vec2(m_position.x, m_position.z);
+	auto rotate = [&](const glm::vec2& vector)
+	{
+		return glm::vec2(vector.x * angleCos - vector.y * angleSin, vector.x * angleSin + vector.y * angleCos);
+	};
 
-				point -= centre;
-				point.x = point.x * angleCos - point.z * angleSin;
-				point.z = point.x * angleSin + point.z * angleCos;
+	if (m_isRectangle)
+	{
+		m_collisionRectangle = m_rectangle;
+		m_collisionRectangle.centre = rotate(m_rectangle.centre - centre) + offset;
+		m_collisionRectangle.axis = rotate(m_rectangle.axis);
 
-				return point + centre;
-			};
+		return;
+	}
 
-			Point newPoint = rotatePointInXZPlane(m_circle.centre, m_rotation.x, point) + m_position;
-			return newPoint;
-		});
-	m_collisionBoundaries = Collision::details::createXZPolygonFromPoints(transformedPoints);
+	// same point count every time, so ring keeps its memory
+	const auto& localRing = m_localBoundaries.outer();
+	auto& ring = m_collisionBoundaries.outer();
+	ring.resize(localRing.size());
+	for (size_t index = 0; index < localRing.size(); ++index)
+	{
+		const glm::vec2 point = rotate(glm::vec2(localRing[index].x(), localRing[index].y()) - centre) + offset;
+		ring[index] = CL::PointXZ(point.x, point.y);
+	}
 }
 
-void Collider2D::clearCollisions()
+CL::PolygonXZ Collider2D::getCollisionPolygon() const
 {
-	m_currentlyInCollision.clear();
+	updateWorldShape();
+	if (m_isRectangle)
+		return Collision::details::createXZPolygonFromPoints(Collider::getRectangleCorners(m_collisionRectangle));
+
+	return m_collisionBoundaries;
 }
 
-bool Collider2D::alreadyInCollisionWith(Collider2D* collider) const
+void Collider2D::clearCollisions()
 {
-	for (const auto& [collisionCollider, collisionObject] : m_currentlyInCollision)
-	{
-		if (collider == collisionCollider)
-			return true;
-	}
-
-	return false;
+	m_currentlyInCollision.clear();
 }
 
-void Collider2D::addCollision(Collider2D* collider, SimulationObject* collisionObject)
+uint32_t Collider2D::addCollision(SimulationObject* collisionObject, uint32_t tags)
 {
-	Collider2DSimulationObjectPair pair = { collider, collisionObject };
-	m_currentlyInCollision.push_back(pair);
+	m_currentlyInCollision.push_back({ collisionObject, tags });
+
+	return static_cast<uint32_t>(m_currentlyInCollision.size() - 1);
 }
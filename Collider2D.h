@@ -14,12 +14,47 @@ namespace Collider
 	static Circle createCircle(const Points& points);
 	bool circlesOverlay(const Circle& firstCircle, const Circle& secondCircle);
 
+	// turned rectangle on XZ plane, other side goes along perpendicular of axis
 	struct Rectangle
 	{
-		Point topLeft, topRight, bottomLeft, bottomRight;
+		glm::vec2 centre = {};
+		// unit direction of first side
+		glm::vec2 axis = glm::vec2(1.0f, 0.0f);
+		// along axis and along its perpendicular
+		glm::vec2 halfSizes = {};
+	};
+	// false when points are not corners of rectangle in order
+	bool createRectangle(const Points& points, Rectangle& rectangle);
+	Points getRectangleCorners(const Rectangle& rectangle);
+	bool rectanglesOverlay(const Rectangle& firstRectangle, const Rectangle& secondRectangle);
+	bool rectangleContains(const Rectangle& rectangle, const Point& point);
+
+	// rectangles to test against one other as arrays, so whole batch
+	// is tested in one loop without branches which compiler vectorizes,
+	// 8 floats fill one AVX register or two SSE ones
+	struct RectangleBatch
+	{
+		static constexpr uint32_t capacity = 8;
+
+		void push(const Rectangle& rectangle);
+
+		float centreX[capacity] = {};
+		float centreZ[capacity] = {};
+		float axisX[capacity] = {};
+		float axisZ[capacity] = {};
+		float halfLength[capacity] = {};
+		float halfWidth[capacity] = {};
+		uint32_t count = 0;
+	};
+	// separating axis test, sides of both rectangles are the only axes to check
+	void rectanglesOverlay(const Rectangle& rectangle, const RectangleBatch& batch, bool* overlays);
+
+	// on XZ plane
+	struct BoundingBox
+	{
+		glm::vec2 min = {};
+		glm::vec2 max = {};
 	};
-	static Rectangle createRectangle(const Points& points);
-	bool rectanglesOverlay(const Rectangle& firstCircle, const Rectangle& secondCircle);
 }
 
 class SimulationObject;
@@ -34,6 +69,7 @@ public:
 	const Points& getBoundaries() const;
 	glm::vec3 getPosition() const;
 	glm::vec3 getRotation() const;
+	Collider::BoundingBox getBoundingBox() const;
 
 	bool canCollideWith(const Collider2D& other) const;
 	bool canCollideWith(uint32_t otherTag) const;
@@ -44,6 +80,9 @@ public:
 	void setSelfTags(const std::vector<std::string>& newSelfTags);
 	void setOtherTags(const std::vector<std::string>& newOtherTags);
 	void setTags(const std::vector<std::string>& newSelfTags, const std::vector<std::string>& newOtherTags);
+	// flags of interned tags, see PhysicsTags
+	void setSelfTags(uint32_t newSelfTags);
+	void setOtherTags(uint32_t newOtherTags);
 
 	void resetSelfTags();
 	void resetOtherTags();
@@ -52,7 +91,9 @@ public:
 	bool hasSelfTags() const;
 	bool hasOtherTags() const;
 	bool isInCollison() const;
-	std::vector<SimulationObject*> getAllCollisionWith(std::string tagName) const;
+	// function(object) once for every object collided with by collider with any of tags
+	template<class Function> void forEachCollisionWith(uint32_t tagFlags, Function&& function) const;
+	std::vector<SimulationObject*> getAllCollisionWith(const std::string& tagName) const;
 private:
 	//Collider2D() = default;
 
@@ -61,20 +102,25 @@ private:
 	void setupCircle();
 
 	void updateCollisionCircle();
-	void updateCollisionBoundaries();
+	// moving only marks shape stale, it is made again when some test needs it,
+	// physics makes it for snapshot so collision jobs never write it
+	void updateWorldShape() const;
+	// rectangles keep no polygon, it is made only for tests with polygons
+	CL::PolygonXZ getCollisionPolygon() const;
 
 	void clearCollisions();
-	bool alreadyInCollisionWith(Collider2D* collider) const;
-	void addCollision(Collider2D* collider, SimulationObject* collisionObject);
+	// returns its entry, so more colliders of same object only add tags
+	uint32_t addCollision(SimulationObject* collisionObject, uint32_t tags);
 
 	uint32_t m_tags = 0;
 	uint32_t m_otherTags = 0;
-	struct Collider2DSimulationObjectPair
+	// every object once, with tags of all its colliders it collided with
+	struct CollisionEntry
 	{
-		Collider2D* collider = nullptr;
 		SimulationObject* object = nullptr;
+		uint32_t tags = 0;
 	};
-	std::vector<Collider2DSimulationObjectPair> m_currentlyInCollision;
+	std::vector<CollisionEntry> m_currentlyInCollision;
 
 	Points m_boundaries;
 
@@ -83,6 +129,24 @@ private:
 	glm::vec3 m_rotation = {};
 
 	Collider::Circle m_collisionCircle;
-	CL::PolygonXZ m_collisionBoundaries;
+
+	// boundaries make rectangle, cars and buildings do
+	bool m_isRectangle = false;
+	// local shape and world one made from it
+	Collider::Rectangle m_rectangle;
+	CL::PolygonXZ m_localBoundaries;
+	mutable bool m_worldShapeStale = false;
+	mutable Collider::Rectangle m_collisionRectangle;
+	mutable CL::PolygonXZ m_collisionBoundaries;
 };
 
+template<class Function>
+void Collider2D::forEachCollisionWith(uint32_t tagFlags, Function&& function) const
+{
+	for (const auto& [object, tags] : m_currentlyInCollision)
+	{
+		if (tags & tagFlags)
+			function(object);
+	}
+}
+
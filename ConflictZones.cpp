@@ -0,0 +1,73 @@
+#include "ConflictZones.h"
+
+void ConflictZones::reset(uint32_t zoneCount)
+{
+	m_zones.assign(zoneCount, {});
+}
+
+uint32_t ConflictZones::findBlockingZone(LaneGraph::Conflicts conflicts, LaneId lane) const
+{
+	for (const auto& conflict : conflicts)
+	{
+		if (isBlocking(m_zones[conflict.zone], lane))
+			return conflict.zone;
+	}
+
+	return noZone;
+}
+
+void ConflictZones::enter(LaneGraph::Conflicts conflicts, LaneId lane)
+{
+	for (const auto& conflict : conflicts)
+	{
+		auto& zone = m_zones[conflict.zone];
+		zone.lane = lane;
+		++zone.vehicles;
+
+		if (zone.waitingLane == lane)
+			zone.waitingLane = invalidLaneId;
+	}
+}
+
+bool ConflictZones::wait(LaneGraph::Conflicts conflicts, LaneId lane)
+{
+	// all or nothing, lanes holding part of promises could wait for each other
+	const bool promisedToOther = std::any_of(std::begin(conflicts), std::end(conflicts), [&](const LaneGraph::Conflict& conflict)
+		{
+			return isPromisedToOther(m_zones[conflict.zone], lane);
+		});
+	if (promisedToOther)
+		return false;
+
+	for (const auto& conflict : conflicts)
+		m_zones[conflict.zone].waitingLane = lane;
+
+	return true;
+}
+
+void ConflictZones::addSleeper(uint32_t zone, uint32_t vehicle)
+{
+	m_zones[zone].sleepers.push_back(vehicle);
+}
+
+void ConflictZones::removeSleeper(uint32_t zone, uint32_t vehicle)
+{
+	auto& sleepers = m_zones[zone].sleepers;
+	sleepers.erase(std::find(std::begin(sleepers), std::end(sleepers), vehicle));
+}
+
+void ConflictZones::renameSleeper(uint32_t zone, uint32_t vehicle, uint32_t newVehicle)
+{
+	auto& sleepers = m_zones[zone].sleepers;
+	*std::find(std::begin(sleepers), std::end(sleepers), vehicle) = newVehicle;
+}
+
+bool ConflictZones::isBlocking(const Zone& zone, LaneId lane)
+{
+	return (zone.vehicles != 0 && zone.lane != lane) || isPromisedToOther(zone, lane);
+}
+
+bool ConflictZones::isPromisedToOther(const Zone& zone, LaneId lane)
+{
+	return zone.waitingLane != invalidLaneId && zone.waitingLane != lane;
+}
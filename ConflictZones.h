@@ -0,0 +1,83 @@
+#pragma once
+#include "LaneGraph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+*	Who drives through conflicts of intersection lanes, first come first served.
+*	Car takes all zones of lane at once before entering it, so cars inside
+*	never wait for each other and no circle of waiting cars forms.
+*	Cars of same lane share zones, they keep distance behind each other anyway.
+*	Cars asleep before zone are woken when it gets free.
+*/
+class ConflictZones
+{
+public:
+	static constexpr uint32_t noZone = UINT32_MAX;
+
+	void reset(uint32_t zoneCount);
+
+	// zone lane cant enter now, noZone when it can enter
+	uint32_t findBlockingZone(LaneGraph::Conflicts conflicts, LaneId lane) const;
+	void enter(LaneGraph::Conflicts conflicts, LaneId lane);
+	// wake(vehicle) for cars sleeping on zone once its free
+	template<class Function> void leave(const LaneGraph::Conflict& conflict, Function&& wake);
+	// lane is promised zones when none of them is promised to other one,
+	// so others dont keep taking them from it, promise lasts until lane enters
+	bool wait(LaneGraph::Conflicts conflicts, LaneId lane);
+	template<class Function> void stopWaiting(LaneGraph::Conflicts conflicts, LaneId lane, Function&& wake);
+
+	void addSleeper(uint32_t zone, uint32_t vehicle);
+	void removeSleeper(uint32_t zone, uint32_t vehicle);
+	// car got other index
+	void renameSleeper(uint32_t zone, uint32_t vehicle, uint32_t newVehicle);
+private:
+	struct Zone
+	{
+		LaneId lane = invalidLaneId;
+		uint32_t vehicles = 0;
+		// lane zone is promised to
+		LaneId waitingLane = invalidLaneId;
+		std::vector<uint32_t> sleepers;
+	};
+	static bool isBlocking(const Zone& zone, LaneId lane);
+	static bool isPromisedToOther(const Zone& zone, LaneId lane);
+	template<class Function> static void wakeSleepers(Zone& zone, Function&& wake);
+
+	std::vector<Zone> m_zones;
+};
+
+template<class Function>
+void ConflictZones::leave(const LaneGraph::Conflict& conflict, Function&& wake)
+{
+	auto& zone = m_zones[conflict.zone];
+	if (--zone.vehicles != 0)
+		return;
+
+	zone.lane = invalidLaneId;
+	wakeSleepers(zone, wake);
+}
+
+template<class Function>
+void ConflictZones::stopWaiting(LaneGraph::Conflicts conflicts, LaneId lane, Function&& wake)
+{
+	for (const auto& conflict : conflicts)
+	{
+		auto& zone = m_zones[conflict.zone];
+		if (zone.waitingLane != lane)
+			continue;
+
+		zone.waitingLane = invalidLaneId;
+		wakeSleepers(zone, wake);
+	}
+}
+
+template<class Function>
+void ConflictZones::wakeSleepers(Zone& zone, Function&& wake)
+{
+	for (const auto& sleeper : zone.sleepers)
+		wake(sleeper);
+	zone.sleepers.clear();
+}
@@ -10,4 +10,9 @@ namespace App
 	Physics			physics			= Physics();
 	Input			input			= Input();
 	Simulation		simulation		= Simulation();
+	JobSystem		jobSystem		= JobSystem();
+	VehicleEngine	vehicleEngine	= VehicleEngine();
+	LaneGraph		laneGraph		= LaneGraph();
+	RouteHierarchy	routeHierarchy	= RouteHierarchy();
+	RouteTable		routeTable		= RouteTable();
 }
\ No newline at end of file
@@ -6,6 +6,11 @@
 #include "Simulation.h"
 #include "Input.h"
 #include "Window.h"
+#include "JobSystem.h"
+#include "VehicleEngine.h"
+#include "LaneGraph.h"
+#include "RouteHierarchy.h"
+#include "RouteTable.h"
 //namespace
 namespace App
 {
@@ -16,5 +21,10 @@ namespace App
 	extern Physics physics;
 	extern Input input;
 	extern Simulation simulation;
+	extern JobSystem jobSystem;
+	extern VehicleEngine vehicleEngine;
+	extern LaneGraph laneGraph;
+	extern RouteHierarchy routeHierarchy;
+	extern RouteTable routeTable;
 }
 
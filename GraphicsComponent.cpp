@@ -122,6 +122,12 @@ void GraphicsComponent::setTransparency(float transparency)
 	m_core->shaderInfo.transparency = transparency;
 }
 
+void GraphicsComponent::setInterpolated(bool interpolated)
+{
+	m_core->interpolate = interpolated;
+	m_core->previousTransformations.valid = false;
+}
+
 bool GraphicsComponent::isActive() const
 {
 	return m_core->active;
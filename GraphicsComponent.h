@@ -30,6 +30,15 @@ struct GraphicsComponentCore
 		glm::vec3 size = { 1.0, 1.0, 1.0 };
 	} transformations;
 
+	// state before last simulation step, drawn position is blended towards current one
+	struct
+	{
+		glm::vec3 position = {};
+		glm::vec3 rotation = {};
+		bool valid = false;
+	} previousTransformations;
+	bool interpolate = false;
+
 	struct
 	{
 		glm::vec4 tint = {};
@@ -70,6 +79,8 @@ public:
 	void setSize(const glm::vec3& size);
 	void setTint(const glm::vec4 & tint);
 	void setTransparency(float transparency);
+	// for objects moved by simulation steps
+	void setInterpolated(bool interpolated);
 	
 
 
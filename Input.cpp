@@ -1,5 +1,4 @@
 #include "Input.h"
-#include "GlobalSynchronization.h"
 
 #include <mutex>
 
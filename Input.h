@@ -8,7 +8,7 @@
 class Input
 {
 	friend class Window;
-	friend int main();
+	friend int main(int argc, char* argv[]);
 public:
 	Input();
 
@@ -0,0 +1,30 @@
+#include "IntelligentDriver.h"
+
+#include <algorithm>
+#include <cmath>
+
+void IntelligentDriver::computeAccelerations(const float* __restrict gaps, const float* __restrict speeds,
+	const float* __restrict leaderSpeeds, const float* __restrict desiredSpeeds,
+	float* __restrict accelerations, uint32_t count)
+{
+	using namespace Settings::IntelligentDriver;
+	const float brakingTerm = 1.0f / (2.0f * std::sqrt(maxAcceleration * comfortableDeceleration));
+
+	for (uint32_t index = 0; index < count; ++index)
+	{
+		const float speed = speeds[index];
+		const float gap = std::max(gaps[index], float(smallestGap));
+
+		// gap driver wants, grows with speed and with closing on car ahead,
+		// clamped as whole since clamping just dynamic part stops vectorizing
+		const float dynamicGap = speed * timeHeadway + speed * (speed - leaderSpeeds[index]) * brakingTerm;
+		const float desiredGap = std::max(minimumGap + dynamicGap, float(minimumGap));
+
+		const float speedRatio = speed / desiredSpeeds[index];
+		const float speedRatioSquared = speedRatio * speedRatio;
+		const float gapRatio = desiredGap / gap;
+
+		// free road term has exponent 4
+		accelerations[index] = maxAcceleration * (1.0f - speedRatioSquared * speedRatioSquared - gapRatio * gapRatio);
+	}
+}
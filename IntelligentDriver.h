@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+namespace Settings
+{
+	namespace IntelligentDriver
+	{
+		constexpr float maxAcceleration = 1.5f;				// meters per second squared
+		// braking driver is fine with, harder only when car ahead gets too close
+		constexpr float comfortableDeceleration = 2.0f;		// meters per second squared
+		// time to car ahead driver keeps at speed
+		constexpr float timeHeadway = 1.5f;					// seconds
+		// space left to car ahead when standing
+		constexpr float minimumGap = 2.0f;					// meters
+		// car closer than this counts as touching, so gap is never zero
+		constexpr float smallestGap = 0.1f;					// meters
+	}
+}
+
+/*
+*	Intelligent driver model, acceleration from free space to car ahead,
+*	own speed, speed of car ahead and speed driver wants to go.
+*	Plain loop over arrays without branches, so compiler vectorizes it
+*	(SSE/AVX by target, needs full optimization).
+*/
+namespace IntelligentDriver
+{
+	void computeAccelerations(const float* __restrict gaps, const float* __restrict speeds,
+		const float* __restrict leaderSpeeds, const float* __restrict desiredSpeeds,
+		float* __restrict accelerations, uint32_t count);
+}
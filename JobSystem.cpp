@@ -0,0 +1,259 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+	// queue of thread running the job, workers set it on start
+	thread_local uint32_t t_queueIndex = UINT32_MAX;
+}
+
+bool JobCounter::finished() const
+{
+	return m_pending.load() == 0;
+}
+
+void JobSystem::initialize(uint32_t workerCount)
+{
+	if (workerCount == 0)
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	// one more for non worker threads
+	m_queues.clear();
+	for (uint32_t index = 0; index < workerCount + 1; ++index)
+		m_queues.emplace_back(std::make_unique<WorkerQueue>());
+
+	m_running.store(true);
+	for (uint32_t index = 0; index < workerCount; ++index)
+		m_workers.emplace_back(&JobSystem::workerLoop, this, index);
+}
+
+void JobSystem::cleanUp()
+{
+	{
+		std::lock_guard sleepLock(m_sleepMutex);
+		m_running.store(false);
+	}
+	m_sleepCondition.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+
+	m_workers.clear();
+	m_queues.clear();
+	m_backgroundQueue.jobs.clear();
+	m_queuedBackgroundJobs.store(0);
+}
+
+void JobSystem::submit(Job job, JobCounter& counter)
+{
+	counter.m_pending.fetch_add(1);
+
+	push(QueuedJob{ std::move(job), &counter });
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, Job job, JobCounter& counter)
+{
+	counter.m_pending.fetch_add(1);
+
+	{
+		std::lock_guard dependencyLock(dependency.m_mutex);
+		if (!dependency.finished())
+		{
+			dependency.m_continuations.push_back(QueuedJob{ std::move(job), &counter });
+			return;
+		}
+	}
+
+	push(QueuedJob{ std::move(job), &counter });
+}
+
+void JobSystem::submitBackground(Job job, JobCounter& counter)
+{
+	counter.m_pending.fetch_add(1);
+
+	{
+		std::lock_guard queueLock(m_backgroundQueue.mutex);
+		m_backgroundQueue.jobs.push_back(QueuedJob{ std::move(job), &counter });
+	}
+
+	{
+		std::lock_guard sleepLock(m_sleepMutex);
+		m_queuedBackgroundJobs.fetch_add(1);
+	}
+	// waiting threads may be woken too, some worker has to get it
+	m_sleepCondition.notify_all();
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	while (!counter.finished())
+	{
+		if (tryRunJob())
+			continue;
+
+		std::unique_lock sleepLock(m_sleepMutex);
+		m_sleepCondition.wait(sleepLock, [&] { return counter.finished() || m_queuedJobs.load() != 0; });
+	}
+
+	std::lock_guard counterLock(counter.m_mutex);
+	if (counter.m_exception)
+	{
+		auto exception = counter.m_exception;
+		counter.m_exception = nullptr;
+
+		std::rethrow_exception(exception);
+	}
+}
+
+uint32_t JobSystem::getThreadCount() const
+{
+	return static_cast<uint32_t>(m_workers.size()) + 1;
+}
+
+void JobSystem::workerLoop(uint32_t queueIndex)
+{
+	t_queueIndex = queueIndex;
+
+	while (m_running.load())
+	{
+		// short jobs go first, someone may wait for them
+		if (tryRunJob() || tryRunBackgroundJob())
+			continue;
+
+		std::unique_lock sleepLock(m_sleepMutex);
+		m_sleepCondition.wait(sleepLock, [&]
+			{
+				return !m_running.load() || m_queuedJobs.load() != 0 || m_queuedBackgroundJobs.load() != 0;
+			});
+	}
+}
+
+void JobSystem::push(QueuedJob queuedJob)
+{
+	auto& queue = *m_queues[currentQueueIndex()];
+	{
+		std::lock_guard queueLock(queue.mutex);
+		queue.jobs.emplace_back(std::move(queuedJob));
+	}
+
+	{
+		std::lock_guard sleepLock(m_sleepMutex);
+		m_queuedJobs.fetch_add(1);
+	}
+	m_sleepCondition.notify_one();
+}
+
+bool JobSystem::tryRunJob()
+{
+	const uint32_t queueIndex = currentQueueIndex();
+
+	QueuedJob queuedJob;
+	if (!popJob(queueIndex, queuedJob) && !stealJob(queueIndex, queuedJob))
+		return false;
+
+	runJob(queuedJob);
+	return true;
+}
+
+bool JobSystem::tryRunBackgroundJob()
+{
+	QueuedJob queuedJob;
+	{
+		std::lock_guard queueLock(m_backgroundQueue.mutex);
+		if (m_backgroundQueue.jobs.empty())
+			return false;
+
+		// oldest first, they were submitted once per frame
+		queuedJob = std::move(m_backgroundQueue.jobs.front());
+		m_backgroundQueue.jobs.pop_front();
+		m_queuedBackgroundJobs.fetch_sub(1);
+	}
+
+	runJob(queuedJob);
+	return true;
+}
+
+void JobSystem::runJob(QueuedJob& queuedJob)
+{
+	try
+	{
+		queuedJob.job();
+	}
+	catch (...)
+	{
+		std::lock_guard counterLock(queuedJob.counter->m_mutex);
+		if (!queuedJob.counter->m_exception)
+			queuedJob.counter->m_exception = std::current_exception();
+	}
+
+	finishJob(*queuedJob.counter);
+}
+
+bool JobSystem::popJob(uint32_t queueIndex, QueuedJob& queuedJob)
+{
+	auto& queue = *m_queues[queueIndex];
+
+	std::lock_guard queueLock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+
+	// newest one, its data are likely still in cache
+	queuedJob = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	m_queuedJobs.fetch_sub(1);
+
+	return true;
+}
+
+bool JobSystem::stealJob(uint32_t queueIndex, QueuedJob& queuedJob)
+{
+	const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+	for (uint32_t offset = 1; offset < queueCount; ++offset)
+	{
+		auto& queue = *m_queues[(queueIndex + offset) % queueCount];
+
+		std::lock_guard queueLock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+
+		// oldest one, usually the biggest piece of work
+		queuedJob = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		m_queuedJobs.fetch_sub(1);
+
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::finishJob(JobCounter& counter)
+{
+	std::vector<QueuedJob> continuations;
+	{
+		// continuations are taken under same lock they are added with
+		std::lock_guard counterLock(counter.m_mutex);
+		if (counter.m_pending.fetch_sub(1) != 1)
+			return;
+
+		continuations.swap(counter.m_continuations);
+	}
+
+	for (auto& continuation : continuations)
+		push(std::move(continuation));
+
+	// wake whoever waits for this counter
+	{
+		std::lock_guard sleepLock(m_sleepMutex);
+	}
+	m_sleepCondition.notify_all();
+}
+
+uint32_t JobSystem::currentQueueIndex() const
+{
+	if (t_queueIndex < m_queues.size() - 1)
+		return t_queueIndex;
+
+	return static_cast<uint32_t>(m_queues.size() - 1);
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Settings
+{
+	namespace JobSystem
+	{
+		// at least this many items go to one parallel for job
+		constexpr uint32_t defaultGrainSize = 64;
+		// parallel for splits work to about this many jobs per thread
+		constexpr uint32_t jobsPerThread = 4;
+	}
+}
+
+/*
+*	Tracks jobs submitted with it, jobs submitted after it
+*	wait until all of them finish
+*/
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool finished() const;
+private:
+	friend class JobSystem;
+
+	struct QueuedJob
+	{
+		std::function<void()> job;
+		JobCounter* counter = nullptr;
+	};
+
+	std::atomic<uint32_t> m_pending = 0;
+	std::mutex m_mutex;
+	std::vector<QueuedJob> m_continuations;
+	std::exception_ptr m_exception;
+};
+
+/*
+*	Every worker owns one queue, pops its newest jobs and when
+*	empty, steals oldest jobs from others. Threads which wait for
+*	counter run jobs meanwhile, so waiting inside job is fine.
+*	Background jobs are taken only by idle workers, so nobody who
+*	waits gets stuck running whole frame of rendering.
+*/
+class JobSystem
+{
+public:
+	using Job = std::function<void()>;
+
+	// 0 means one worker per hardware thread except the calling one
+	void initialize(uint32_t workerCount = 0);
+	void cleanUp();
+
+	void submit(Job job, JobCounter& counter);
+	void submitAfter(JobCounter& dependency, Job job, JobCounter& counter);
+	// long frame level job, nothing waits inside it except for its own jobs
+	void submitBackground(Job job, JobCounter& counter);
+	// rethrows first exception thrown from counter's jobs
+	void wait(JobCounter& counter);
+
+	// calls function(begin, end) on disjoint ranges covering [0, count)
+	template<class Function> void parallelFor(uint32_t count, Function&& function,
+		uint32_t grainSize = Settings::JobSystem::defaultGrainSize);
+
+	uint32_t getThreadCount() const;
+private:
+	using QueuedJob = JobCounter::QueuedJob;
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<QueuedJob> jobs;
+	};
+
+	void workerLoop(uint32_t queueIndex);
+	void push(QueuedJob queuedJob);
+	bool tryRunJob();
+	bool tryRunBackgroundJob();
+	void runJob(QueuedJob& queuedJob);
+	bool popJob(uint32_t queueIndex, QueuedJob& queuedJob);
+	bool stealJob(uint32_t queueIndex, QueuedJob& queuedJob);
+	void finishJob(JobCounter& counter);
+	uint32_t currentQueueIndex() const;
+
+	// last queue is shared by threads that are not workers
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_workers;
+
+	// shared by workers, waiting threads never take from it
+	WorkerQueue m_backgroundQueue;
+
+	std::atomic<uint32_t> m_queuedJobs = 0;
+	std::atomic<uint32_t> m_queuedBackgroundJobs = 0;
+	std::atomic<bool> m_running = false;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+};
+
+template<class Function>
+void JobSystem::parallelFor(uint32_t count, Function&& function, uint32_t grainSize)
+{
+	if (count == 0)
+		return;
+
+	const uint32_t jobCount = getThreadCount() * Settings::JobSystem::jobsPerThread;
+	const uint32_t chunkSize = std::max(std::max(grainSize, 1u), (count + jobCount - 1) / jobCount);
+
+	// not worth splitting
+	if (m_workers.empty() || count <= chunkSize)
+	{
+		function(uint32_t(0), count);
+		return;
+	}
+
+	JobCounter counter;
+	for (uint32_t begin = 0; begin < count; begin += chunkSize)
+	{
+		const uint32_t end = std::min(begin + chunkSize, count);
+		submit([&function, begin, end] { function(begin, end); }, counter);
+	}
+	wait(counter);
+}
@@ -0,0 +1,268 @@
+#include "LaneGraph.h"
+#include "RoadIntersection.h"
+#include "UniformGrid.h"
+#include "Utilities.h"
+
+#include <algorithm>
+
+void LaneGraph::build(const std::vector<const BasicRoad*>& roads)
+{
+	clear();
+
+	LaneConflicts conflicts;
+	for (const auto& road : roads)
+		addRoad(road, conflicts);
+
+	connectLanes();
+	storeConflicts(std::move(conflicts));
+}
+
+void LaneGraph::clear()
+{
+	m_lanes.clear();
+	m_points.clear();
+	m_distances.clear();
+	m_roadLanes.clear();
+
+	m_successorOffsets.clear();
+	m_successors.clear();
+	m_predecessorOffsets.clear();
+	m_predecessors.clear();
+	m_conflictOffsets.clear();
+	m_conflicts.clear();
+	m_conflictZoneCount = 0;
+}
+
+bool LaneGraph::isBuiltFrom(const std::vector<const BasicRoad*>& roads) const
+{
+	if (roads.size() != m_roadLanes.size())
+		return false;
+
+	return std::all_of(std::begin(roads), std::end(roads), [this](const BasicRoad* road)
+		{
+			return m_roadLanes.count(road) != 0;
+		});
+}
+
+uint32_t LaneGraph::getLaneCount() const
+{
+	return static_cast<uint32_t>(m_lanes.size());
+}
+
+LaneGraph::RoadLanes LaneGraph::getRoadLanes(const BasicRoad* road) const
+{
+	auto roadLanes = m_roadLanes.find(road);
+	if (roadLanes == m_roadLanes.end())
+		return RoadLanes();
+
+	return roadLanes->second;
+}
+
+const Points& LaneGraph::getPoints(LaneId lane) const
+{
+	return m_points[lane];
+}
+
+const ArcLength::Table& LaneGraph::getDistances(LaneId lane) const
+{
+	return m_distances[lane];
+}
+
+float LaneGraph::getLength(LaneId lane) const
+{
+	return ArcLength::length(m_distances[lane]);
+}
+
+float LaneGraph::getSpeedLimit(LaneId lane) const
+{
+	return m_lanes[lane].speedLimit;
+}
+
+float LaneGraph::getTravelTime(LaneId lane) const
+{
+	return getLength(lane) / getSpeedLimit(lane);
+}
+
+const BasicRoad* LaneGraph::getRoad(LaneId lane) const
+{
+	return m_lanes[lane].road;
+}
+
+const BasicRoad* LaneGraph::getConnectsFrom(LaneId lane) const
+{
+	return m_lanes[lane].connectsFrom;
+}
+
+const BasicRoad* LaneGraph::getConnectsTo(LaneId lane) const
+{
+	return m_lanes[lane].connectsTo;
+}
+
+Lane::Side LaneGraph::getSide(LaneId lane) const
+{
+	return m_lanes[lane].side;
+}
+
+bool LaneGraph::areParallel(LaneId lane, LaneId otherLane) const
+{
+	const auto& info = m_lanes[lane];
+	const auto& otherInfo = m_lanes[otherLane];
+
+	return info.road == otherInfo.road && info.side == otherInfo.side &&
+		info.connectsFrom == otherInfo.connectsFrom && info.connectsTo == otherInfo.connectsTo;
+}
+
+LaneGraph::LaneIds LaneGraph::getSuccessors(LaneId lane) const
+{
+	return LaneIds{ m_successors.data() + m_successorOffsets[lane], m_successors.data() + m_successorOffsets[lane + 1] };
+}
+
+LaneGraph::LaneIds LaneGraph::getPredecessors(LaneId lane) const
+{
+	return LaneIds{ m_predecessors.data() + m_predecessorOffsets[lane], m_predecessors.data() + m_predecessorOffsets[lane + 1] };
+}
+
+LaneGraph::Conflicts LaneGraph::getConflicts(LaneId lane) const
+{
+	return Conflicts{ m_conflicts.data() + m_conflictOffsets[lane], m_conflicts.data() + m_conflictOffsets[lane + 1] };
+}
+
+uint32_t LaneGraph::getConflictZoneCount() const
+{
+	return m_conflictZoneCount;
+}
+
+float LaneGraph::getRoadSpeedLimit(const BasicRoad* road)
+{
+	switch (road->getRoadType())
+	{
+	case BasicRoad::RoadType::INTERSECTION:
+		return Settings::LaneGraph::intersectionSpeedLimit;
+	case BasicRoad::RoadType::CAR_SPAWNER:
+		return Settings::LaneGraph::spawnerSpeedLimit;
+	default:
+		return Settings::LaneGraph::roadSpeedLimit;
+	}
+}
+
+void LaneGraph::addRoad(const BasicRoad* road, LaneConflicts& conflicts)
+{
+	RoadLanes roadLanes;
+	roadLanes.first = getLaneCount();
+
+	// copied just this once
+	auto lanes = road->getAllLanes();
+	// road counts conflicts by index of its right lane
+	std::vector<LaneId> rightLaneIds(lanes[Lane::Side::RIGHT].size(), invalidLaneId);
+	// fixed order so same network gets same ids
+	for (const auto side : { Lane::Side::RIGHT, Lane::Side::LEFT })
+	{
+		for (uint32_t index = 0; index < lanes[side].size(); ++index)
+		{
+			auto& lane = lanes[side][index];
+			if (lane.points.size() < 2)
+				continue;
+
+			if (side == Lane::Side::RIGHT)
+				rightLaneIds[index] = getLaneCount();
+
+			LaneInfo info;
+			info.road = road;
+			info.connectsFrom = lane.connectsFrom;
+			info.connectsTo = lane.connectsTo;
+			info.side = side;
+			info.speedLimit = getRoadSpeedLimit(road);
+			m_lanes.push_back(info);
+
+			if (lane.distances.size() != lane.points.size())
+				lane.distances = ArcLength::createTable(lane.points);
+			m_distances.emplace_back(std::move(lane.distances));
+			m_points.emplace_back(std::move(lane.points));
+		}
+	}
+
+	roadLanes.last = getLaneCount();
+	m_roadLanes[road] = roadLanes;
+
+	if (road->getRoadType() != BasicRoad::RoadType::INTERSECTION)
+		return;
+
+	for (const auto& laneConflict : static_cast<const RoadIntersection*>(road)->getLaneConflicts())
+	{
+		const LaneId lane = rightLaneIds[laneConflict.lane];
+		const LaneId otherLane = rightLaneIds[laneConflict.otherLane];
+		if (lane == invalidLaneId || otherLane == invalidLaneId)
+			continue;
+
+		const uint32_t zone = m_conflictZoneCount++;
+		conflicts.emplace_back(lane, Conflict{ zone, laneConflict.start, laneConflict.end });
+		conflicts.emplace_back(otherLane, Conflict{ zone, laneConflict.otherStart, laneConflict.otherEnd });
+	}
+}
+
+void LaneGraph::connectLanes()
+{
+	const uint32_t laneCount = getLaneCount();
+
+	// starts are bucketed so every end checks only few of them
+	UniformGrid laneStarts;
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+	{
+		const glm::vec2 start(m_points[lane].front().x, m_points[lane].front().z);
+		laneStarts.insert(lane, start, start);
+	}
+
+	m_successorOffsets.assign(laneCount + 1, 0);
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+	{
+		const auto& laneEnd = m_points[lane].back();
+		const glm::vec2 end(laneEnd.x, laneEnd.z);
+		const glm::vec2 searchExtent(Settings::LaneGraph::endpointTolerance);
+
+		const auto successorsStart = m_successors.size();
+		laneStarts.query(end - searchExtent, end + searchExtent, [&](uint32_t otherLane)
+			{
+				if (otherLane != lane && approxSamePoints(laneEnd, m_points[otherLane].front()))
+					m_successors.push_back(otherLane);
+			});
+		// same order no matter how grid stores them
+		std::sort(std::begin(m_successors) + successorsStart, std::end(m_successors));
+
+		m_successorOffsets[lane + 1] = static_cast<uint32_t>(m_successors.size());
+	}
+
+	// predecessors are successors turned around
+	m_predecessorOffsets.assign(laneCount + 1, 0);
+	for (const auto& successor : m_successors)
+		++m_predecessorOffsets[successor + 1];
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+		m_predecessorOffsets[lane + 1] += m_predecessorOffsets[lane];
+
+	m_predecessors.resize(m_successors.size());
+	auto fillPositions = m_predecessorOffsets;
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+	{
+		for (const auto& successor : getSuccessors(lane))
+			m_predecessors[fillPositions[successor]++] = lane;
+	}
+}
+
+void LaneGraph::storeConflicts(LaneConflicts conflicts)
+{
+	// car passes them in order of their end
+	std::sort(std::begin(conflicts), std::end(conflicts), [](const auto& lhs, const auto& rhs)
+		{
+			return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second.end < rhs.second.end;
+		});
+
+	const uint32_t laneCount = getLaneCount();
+	m_conflictOffsets.assign(laneCount + 1, 0);
+	m_conflicts.reserve(conflicts.size());
+	for (const auto& [lane, conflict] : conflicts)
+	{
+		++m_conflictOffsets[lane + 1];
+		m_conflicts.push_back(conflict);
+	}
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+		m_conflictOffsets[lane + 1] += m_conflictOffsets[lane];
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "BasicRoad.h"
+#include "ArcLength.h"
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace Settings
+{
+	namespace LaneGraph
+	{
+		// same as approxSamePoints, which decides in the end
+		constexpr float endpointTolerance = 0.01f;		// meters
+		// meters per second
+		constexpr float roadSpeedLimit = 50.0f / 3.6f;
+		constexpr float intersectionSpeedLimit = 30.0f / 3.6f;
+		constexpr float spawnerSpeedLimit = 20.0f / 3.6f;
+		constexpr float maxSpeedLimit = roadSpeedLimit;
+	}
+}
+
+using LaneId = uint32_t;
+constexpr LaneId invalidLaneId = UINT32_MAX;
+
+/*
+*	Every lane of network compiled once when simulation starts,
+*	lanes are refered to by id and their geometry is stored only here.
+*	Lane leads to another when its end sits on others start.
+*/
+class LaneGraph
+{
+public:
+	// lanes next to each other in array
+	struct LaneIds
+	{
+		const LaneId* first = nullptr;
+		const LaneId* last = nullptr;
+
+		const LaneId* begin() const { return first; }
+		const LaneId* end() const { return last; }
+		uint32_t size() const { return static_cast<uint32_t>(last - first); }
+		bool empty() const { return first == last; }
+	};
+	// lanes of one road get ids from first to one past last
+	struct RoadLanes
+	{
+		LaneId first = 0;
+		LaneId last = 0;
+
+		uint32_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+	};
+	// part of intersection lane where it crosses or merges with other lane
+	struct Conflict
+	{
+		// same zone for both lanes of conflict
+		uint32_t zone = 0;
+		// arc lengths along lane
+		float start = 0.0f;
+		float end = 0.0f;
+	};
+	struct Conflicts
+	{
+		const Conflict* first = nullptr;
+		const Conflict* last = nullptr;
+
+		const Conflict* begin() const { return first; }
+		const Conflict* end() const { return last; }
+		uint32_t size() const { return static_cast<uint32_t>(last - first); }
+		bool empty() const { return first == last; }
+		const Conflict& operator[](uint32_t index) const { return first[index]; }
+	};
+
+	// roads need to have their lanes created
+	void build(const std::vector<const BasicRoad*>& roads);
+	void clear();
+	// built from exactly these roads, their lanes may have changed since
+	bool isBuiltFrom(const std::vector<const BasicRoad*>& roads) const;
+
+	uint32_t getLaneCount() const;
+	RoadLanes getRoadLanes(const BasicRoad* road) const;
+
+	const Points& getPoints(LaneId lane) const;
+	const ArcLength::Table& getDistances(LaneId lane) const;
+	float getLength(LaneId lane) const;
+	float getSpeedLimit(LaneId lane) const;
+	// seconds to drive whole lane at speed limit
+	float getTravelTime(LaneId lane) const;
+
+	const BasicRoad* getRoad(LaneId lane) const;
+	const BasicRoad* getConnectsFrom(LaneId lane) const;
+	const BasicRoad* getConnectsTo(LaneId lane) const;
+	Lane::Side getSide(LaneId lane) const;
+	// same road and direction, car may switch between them where road allows
+	bool areParallel(LaneId lane, LaneId otherLane) const;
+
+	LaneIds getSuccessors(LaneId lane) const;
+	LaneIds getPredecessors(LaneId lane) const;
+
+	// ordered by their end
+	Conflicts getConflicts(LaneId lane) const;
+	uint32_t getConflictZoneCount() const;
+private:
+	struct LaneInfo
+	{
+		const BasicRoad* road = nullptr;
+		const BasicRoad* connectsFrom = nullptr;
+		const BasicRoad* connectsTo = nullptr;
+		Lane::Side side = {};
+		float speedLimit = 0.0f;
+	};
+
+	static float getRoadSpeedLimit(const BasicRoad* road);
+	using LaneConflicts = std::vector<std::pair<LaneId, Conflict>>;
+	void addRoad(const BasicRoad* road, LaneConflicts& conflicts);
+	void connectLanes();
+	void storeConflicts(LaneConflicts conflicts);
+
+	std::vector<LaneInfo> m_lanes;
+	std::vector<Points> m_points;
+	std::vector<ArcLength::Table> m_distances;
+	std::unordered_map<const BasicRoad*, RoadLanes> m_roadLanes;
+
+	// compressed rows, lane's neighbours are from offsets[lane] to offsets[lane + 1]
+	std::vector<uint32_t> m_successorOffsets;
+	std::vector<LaneId> m_successors;
+	std::vector<uint32_t> m_predecessorOffsets;
+	std::vector<LaneId> m_predecessors;
+	std::vector<uint32_t> m_conflictOffsets;
+	std::vector<Conflict> m_conflicts;
+	uint32_t m_conflictZoneCount = 0;
+};
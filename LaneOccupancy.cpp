@@ -0,0 +1,65 @@
+#include "LaneOccupancy.h"
+
+void LaneOccupancy::reset(uint32_t laneCount)
+{
+	m_vehicles.assign(laneCount, {});
+	m_places.clear();
+	m_occupiedLanes.clear();
+	m_occupiedIndex.assign(laneCount, notOccupied);
+	m_unsortedLanes.clear();
+	m_unsorted.assign(laneCount, false);
+}
+
+void LaneOccupancy::remove(LaneId lane, uint32_t vehicle)
+{
+	auto& vehicles = m_vehicles[lane];
+	const uint32_t place = m_places[vehicle];
+	vehicles.erase(std::begin(vehicles) + place);
+	for (uint32_t index = place; index < vehicles.size(); ++index)
+		m_places[vehicles[index]] = index;
+	if (!vehicles.empty())
+		return;
+
+	// last occupied lane takes its place
+	const uint32_t index = m_occupiedIndex[lane];
+	const LaneId movedLane = m_occupiedLanes.back();
+	m_occupiedLanes[index] = movedLane;
+	m_occupiedIndex[movedLane] = index;
+
+	m_occupiedLanes.pop_back();
+	m_occupiedIndex[lane] = notOccupied;
+}
+
+void LaneOccupancy::rename(LaneId lane, uint32_t vehicle, uint32_t newVehicle)
+{
+	const uint32_t place = m_places[vehicle];
+	m_vehicles[lane][place] = newVehicle;
+
+	if (newVehicle >= m_places.size())
+		m_places.resize(newVehicle + 1);
+	m_places[newVehicle] = place;
+}
+
+void LaneOccupancy::markUnsorted(LaneId lane)
+{
+	if (m_unsorted[lane])
+		return;
+
+	m_unsorted[lane] = true;
+	m_unsortedLanes.push_back(lane);
+}
+
+const std::vector<uint32_t>& LaneOccupancy::getVehicles(LaneId lane) const
+{
+	return m_vehicles[lane];
+}
+
+uint32_t LaneOccupancy::getPlace(uint32_t vehicle) const
+{
+	return m_places[vehicle];
+}
+
+const std::vector<LaneId>& LaneOccupancy::getOccupiedLanes() const
+{
+	return m_occupiedLanes;
+}
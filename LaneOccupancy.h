@@ -0,0 +1,96 @@
+#pragma once
+#include "LaneGraph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+*	Cars on every lane ordered by distance from lane start,
+*	so car ahead is next one in list. Kept between steps,
+*	cars are moved only when they change lane and lanes
+*	are sorted only when some car on them moved.
+*	positionOf(vehicle) gives distance of car from start of its lane.
+*/
+class LaneOccupancy
+{
+public:
+	void reset(uint32_t laneCount);
+
+	template<class Position> void insert(LaneId lane, uint32_t vehicle, Position&& positionOf);
+	void remove(LaneId lane, uint32_t vehicle);
+	// car got other index
+	void rename(LaneId lane, uint32_t vehicle, uint32_t newVehicle);
+	// car on lane moved, lane is sorted in next sortLanes
+	void markUnsorted(LaneId lane);
+	// cars pass each other only when standing on same spot,
+	// so lanes are nearly sorted and few swaps fix them
+	template<class Position> void sortLanes(Position&& positionOf);
+
+	// from lane start to lane end
+	const std::vector<uint32_t>& getVehicles(LaneId lane) const;
+	// where car is in vehicles of its lane
+	uint32_t getPlace(uint32_t vehicle) const;
+	const std::vector<LaneId>& getOccupiedLanes() const;
+private:
+	static constexpr uint32_t notOccupied = UINT32_MAX;
+
+	std::vector<std::vector<uint32_t>> m_vehicles;
+	// kept with every move, so car is never searched for
+	std::vector<uint32_t> m_places;
+	std::vector<LaneId> m_occupiedLanes;
+	// where lane is in occupied ones
+	std::vector<uint32_t> m_occupiedIndex;
+	std::vector<LaneId> m_unsortedLanes;
+	std::vector<bool> m_unsorted;
+};
+
+template<class Position>
+void LaneOccupancy::insert(LaneId lane, uint32_t vehicle, Position&& positionOf)
+{
+	auto& vehicles = m_vehicles[lane];
+	if (vehicles.empty())
+	{
+		m_occupiedIndex[lane] = static_cast<uint32_t>(m_occupiedLanes.size());
+		m_occupiedLanes.push_back(lane);
+	}
+
+	// usually goes first, since car just got on lane
+	const float position = positionOf(vehicle);
+	auto place = std::find_if(std::begin(vehicles), std::end(vehicles), [&](uint32_t other)
+		{
+			return positionOf(other) > position;
+		});
+	place = vehicles.insert(place, vehicle);
+
+	if (vehicle >= m_places.size())
+		m_places.resize(vehicle + 1);
+	for (; place != std::end(vehicles); ++place)
+		m_places[*place] = static_cast<uint32_t>(place - std::begin(vehicles));
+}
+
+template<class Position>
+void LaneOccupancy::sortLanes(Position&& positionOf)
+{
+	for (const auto& lane : m_unsortedLanes)
+	{
+		m_unsorted[lane] = false;
+
+		auto& vehicles = m_vehicles[lane];
+		for (size_t index = 1; index < vehicles.size(); ++index)
+		{
+			const uint32_t vehicle = vehicles[index];
+			const float position = positionOf(vehicle);
+
+			size_t place = index;
+			for (; place > 0 && positionOf(vehicles[place - 1]) > position; --place)
+			{
+				vehicles[place] = vehicles[place - 1];
+				m_places[vehicles[place]] = static_cast<uint32_t>(place);
+			}
+			vehicles[place] = vehicle;
+			m_places[vehicle] = static_cast<uint32_t>(place);
+		}
+	}
+	m_unsortedLanes.clear();
+}
@@ -0,0 +1,50 @@
+#include "LaneTravelTimes.h"
+
+#include <algorithm>
+
+void LaneTravelTimes::reset(const LaneGraph& laneGraph)
+{
+	const uint32_t laneCount = laneGraph.getLaneCount();
+
+	m_freeTravelTimes.resize(laneCount);
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+		m_freeTravelTimes[lane] = laneGraph.getTravelTime(lane);
+	m_travelTimes = m_freeTravelTimes;
+
+	m_sampleSums.assign(laneCount, 0.0f);
+	m_sampleCounts.assign(laneCount, 0);
+	m_longestWaiting.assign(laneCount, 0.0f);
+}
+
+void LaneTravelTimes::addSample(LaneId lane, float travelTime)
+{
+	m_sampleSums[lane] += travelTime;
+	++m_sampleCounts[lane];
+}
+
+void LaneTravelTimes::addWaiting(LaneId lane, float waitingTime)
+{
+	m_longestWaiting[lane] = std::max(m_longestWaiting[lane], waitingTime);
+}
+
+void LaneTravelTimes::update()
+{
+	constexpr float smoothing = Settings::LaneTravelTimes::smoothing;
+
+	for (LaneId lane = 0; lane < m_travelTimes.size(); ++lane)
+	{
+		float measured = m_sampleCounts[lane] ? m_sampleSums[lane] / m_sampleCounts[lane] : m_freeTravelTimes[lane];
+		measured = std::max({ measured, m_longestWaiting[lane], m_freeTravelTimes[lane] });
+
+		m_travelTimes[lane] += (measured - m_travelTimes[lane]) * smoothing;
+	}
+
+	std::fill(std::begin(m_sampleSums), std::end(m_sampleSums), 0.0f);
+	std::fill(std::begin(m_sampleCounts), std::end(m_sampleCounts), 0);
+	std::fill(std::begin(m_longestWaiting), std::end(m_longestWaiting), 0.0f);
+}
+
+const std::vector<float>& LaneTravelTimes::getTravelTimes() const
+{
+	return m_travelTimes;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "LaneGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Settings
+{
+	namespace LaneTravelTimes
+	{
+		// how much new measurement moves smoothed travel time
+		constexpr float smoothing = 0.3f;
+	}
+}
+
+/*
+*	Travel time of every lane measured from cars driving it,
+*	smoothed so one slow car doesnt throw routes around.
+*	Lane nobody left counts as free unless someone is stuck
+*	on it longer. Never below time at speed limit, so A*
+*	estimate stays valid with these weights.
+*/
+class LaneTravelTimes
+{
+public:
+	void reset(const LaneGraph& laneGraph);
+
+	// car left lane after driving it this long
+	void addSample(LaneId lane, float travelTime);
+	// car is still on lane after this long
+	void addWaiting(LaneId lane, float waitingTime);
+	// folds measurements since last call into travel times
+	void update();
+
+	const std::vector<float>& getTravelTimes() const;
+private:
+	std::vector<float> m_freeTravelTimes;
+	std::vector<float> m_travelTimes;
+
+	// since last update
+	std::vector<float> m_sampleSums;
+	std::vector<uint32_t> m_sampleCounts;
+	std::vector<float> m_longestWaiting;
+};
@@ -36,6 +36,51 @@ void ObjectManager::update()
 }
 
 
+void ObjectManager::buildGridNetwork(uint32_t roadCount, float blockLength)
+{
+	if (roadCount == 0)
+		return;
+
+	// one lane roads have no lanes to drive on
+	m_roadCreator.selectPrototype("2-lane road");
+
+	// grid is centered and every road sticks out one block
+	const float halfSpan = float(roadCount - 1) * blockLength / 2.0f;
+	const float gridBegin = -halfSpan - blockLength;
+	const float gridEnd = halfSpan + blockLength;
+	auto coordinate = [&](uint32_t index) { return float(index) * blockLength - halfSpan; };
+
+	// horizontal roads go through whole grid
+	for (uint32_t row = 0; row < roadCount; ++row)
+		m_roadCreator.constructRoad({ Point(gridBegin, 0.0f, coordinate(row)), Point(gridEnd, 0.0f, coordinate(row)) });
+
+	// vertical ones by segments, so each crossing builds or extends intersection
+	for (uint32_t column = 0; column < roadCount; ++column)
+	{
+		const float x = coordinate(column);
+
+		float fromZ = gridBegin;
+		for (uint32_t row = 0; row < roadCount; ++row)
+		{
+			m_roadCreator.constructRoad({ Point(x, 0.0f, fromZ), Point(x, 0.0f, coordinate(row)) });
+			fromZ = coordinate(row);
+		}
+		m_roadCreator.constructRoad({ Point(x, 0.0f, fromZ), Point(x, 0.0f, gridEnd) });
+	}
+
+	// spawner on every dead end, a bit inside so point sits on road
+	const float inset = 1.0f;
+	for (uint32_t index = 0; index < roadCount; ++index)
+	{
+		const float position = coordinate(index);
+
+		m_roadCreator.constructSpawner(Point(gridBegin + inset, 0.0f, position));
+		m_roadCreator.constructSpawner(Point(gridEnd - inset, 0.0f, position));
+		m_roadCreator.constructSpawner(Point(position, 0.0f, gridBegin + inset));
+		m_roadCreator.constructSpawner(Point(position, 0.0f, gridEnd - inset));
+	}
+}
+
 void ObjectManager::setCreatorsModes(Creator::CreatorMode mode)
 {
 	m_currentCreatorMode = mode;
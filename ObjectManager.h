@@ -61,6 +61,8 @@ public:
 	void setCurrentCreator(CreatorType creatorType);
 
 	void drawUI();
+	// scripted network for runs without mouse
+	void buildGridNetwork(uint32_t roadCount, float blockLength);
 //
 private:
 	SimulationArea* m_pSimulationArea;
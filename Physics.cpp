@@ -1,55 +1,28 @@
 #include "Physics.h"
 #include "PhysicsComponent.h"
-#include "GlobalSynchronization.h"
+#include "GlobalObjects.h"
 #include "SimulationObject.h"
 #include <iostream>
-
-void Physics::run()
-{
-	initialize();
-
-	mainLoop();
-
-	destroyResourcces();
-}
+#include <algorithm>
+#include <atomic>
 
 void Physics::initialize()
 {
 	prepareResources();
 }
 
-void Physics::mainLoop()
+void Physics::cleanUp()
 {
-	{
-		std::lock_guard notifyLock(GlobalSynchronizaion::physics.notifyMutex);
-
-		GlobalSynchronizaion::physics.initialized.store(true);
-		GlobalSynchronizaion::main_cv.notify_one();
-	}
-	while (GlobalSynchronizaion::shouldStopEngine.load() == false)
-	{
-		{
-			//std::cout << "P wait\n";
-			std::unique_lock updateWaitLock(GlobalSynchronizaion::physics.updateWaitMutex);
-
-			auto waitPred = [] { return GlobalSynchronizaion::physics.update.load(); };
-			while (!waitPred())
-				GlobalSynchronizaion::thread_cv.wait(updateWaitLock);
-
-			GlobalSynchronizaion::physics.update.store(false);
-		}
-
-		prepareFrame();
-		updateCollisions();
+	destroyResourcces();
+}
 
-		{
-			//std::cout << "P finished\n";
-			std::lock_guard notifyLock(GlobalSynchronizaion::physics.notifyMutex);
+void Physics::swapFrame()
+{
+	publishCollisions();
+	releaseCores();
+	prepareFrame();
 
-			GlobalSynchronizaion::physics.updated.store(true);
-			GlobalSynchronizaion::main_cv.notify_one();
-		}
-	}
+	m_publishedStatistics = m_statistics;
 }
 
 pPhysicsComponentCore Physics::createPhysicsComponentCore()
@@ -59,8 +32,16 @@ pPhysicsComponentCore Physics::createPhysicsComponentCore()
 
 void Physics::copyPhysicsComponentCore(const pPhysicsComponentCore& copyPhysicsCore, pPhysicsComponentCore& destinationPhysicsCore)
 {
+	const auto version = destinationPhysicsCore->version;
+	const auto colliders = destinationPhysicsCore->colliders;
+
 	*destinationPhysicsCore = *copyPhysicsCore;
+	// core keeps its own slots, just their content is copied
+	destinationPhysicsCore->colliders = colliders;
+	std::copy_n(copyPhysicsCore->colliders, Settings::PhysicsComponentCore::colliderSlots, colliders);
 	destinationPhysicsCore->pOwner = nullptr;
+	destinationPhysicsCore->released = false;
+	destinationPhysicsCore->version = version + 1;
 }
 
 pPhysicsComponentCore Physics::copyCreatePhysicsComponentCore(const pPhysicsComponentCore& copyPhysicsCore)
@@ -76,9 +57,9 @@ void Physics::deactivatePhysicsComponentCore(pPhysicsComponentCore& physicsCompo
 	m_activePhysicsComponentCores.erase(
 		std::find(std::begin(m_activePhysicsComponentCores), std::end(m_activePhysicsComponentCores), physicsComponentCore));
 
-	m_physicsComponentCores.push(physicsComponentCore);
+	physicsComponentCore->released = true;
+	m_releasedPhysicsComponentCores.push_back(physicsComponentCore);
 
-	*physicsComponentCore = {};
 	physicsComponentCore = nullptr;
 }
 
@@ -94,6 +75,8 @@ uint32_t Physics::getTagsFlag(const std::vector<std::string>& tagNames)
 
 uint32_t Physics::getTagFlag(const std::string& tagName)
 {
+	std::lock_guard tagLock(m_tagMutex);
+
 	auto optFlag = m_tagFlags.find(tagName);
 	if (optFlag != m_tagFlags.end())
 		return optFlag->second;
@@ -101,14 +84,49 @@ uint32_t Physics::getTagFlag(const std::string& tagName)
 		return createTagFlag(tagName);
 }
 
+uint32_t Physics::getColliderSlot(const std::string& colliderName)
+{
+	std::lock_guard tagLock(m_tagMutex);
+
+	auto optSlot = m_colliderSlots.find(colliderName);
+	if (optSlot != m_colliderSlots.end())
+		return optSlot->second;
+
+	const uint32_t slot = static_cast<uint32_t>(m_colliderSlots.size());
+	if (slot >= Settings::PhysicsComponentCore::colliderSlots)
+		throw std::runtime_error("No free collider slot for collider with name " + colliderName);
+
+	m_colliderSlots[colliderName] = slot;
+	return slot;
+}
+
 bool Physics::compatibleTags(uint32_t firstFlags, uint32_t secondFlags) const
 {
 	return (firstFlags & secondFlags) != 0;
 }
 
+Physics::Statistics Physics::getStatistics() const
+{
+	return m_publishedStatistics;
+}
+
+void Physics::setBroadPhase(BroadPhase broadPhase)
+{
+	m_nextBroadPhase = broadPhase;
+}
+
+Physics::BroadPhase Physics::getBroadPhase() const
+{
+	return m_nextBroadPhase;
+}
+
 
 pPhysicsComponentCore Physics::getPhysicsComponentCore()
 {
+	// cores are handed out as pointers to pool, so it can not grow
+	if (m_physicsComponentCores.empty())
+		throw std::runtime_error("No free physics component core, all " + std::to_string(m_physicsComponentCoreCount) + " are taken");
+
 	auto ptr = m_physicsComponentCores.top();
 	m_physicsComponentCores.pop();
 
@@ -120,132 +138,366 @@ void Physics::prepareResources()
 {
 	m_physicsComponentCoreCount = 50'000;
 	m_physicsComponentCoreData = new PhysicsComponentCore[m_physicsComponentCoreCount];
+	m_colliderData = new Collider2D[m_physicsComponentCoreCount * Settings::PhysicsComponentCore::colliderSlots];
 
 	// copy reverse
 	for (int index = m_physicsComponentCoreCount - 1; index >= 0; --index)
+	{
+		m_physicsComponentCoreData[index].colliders = m_colliderData + index * Settings::PhysicsComponentCore::colliderSlots;
 		m_physicsComponentCores.push(m_physicsComponentCoreData + index);
+	}
+	m_sweepProxies.assign(m_physicsComponentCoreCount * Settings::PhysicsComponentCore::colliderSlots, {});
 
 	// tag flag default
 	// so we have at least one string tag
 	m_tagFlags[std::string()] = 0;
+	// in order of their flags, names made later get next ones
+	m_tagFlags["ROAD"] = PhysicsTags::road;
+	m_colliderSlots["BODY"] = ColliderSlots::body;
 }
 
 void Physics::destroyResourcces()
 {
-	{
-		std::unique_lock cleanupWaitLock(GlobalSynchronizaion::physics.cleanupWaitMutex);
-		GlobalSynchronizaion::thread_cv.wait(cleanupWaitLock, [] { return GlobalSynchronizaion::physics.cleanUp.load(); });
-		GlobalSynchronizaion::physics.cleanUp.store(false);
-	}
-
 	m_physicsComponentCores = {};
 	m_activePhysicsComponentCores = {};
+	m_releasedPhysicsComponentCores = {};
+
+	m_sweepAndPrune.clear();
+	m_sweepProxies = {};
+	m_proxyPoolIndices = {};
 
 	delete[]  m_physicsComponentCoreData;
+	delete[]  m_colliderData;
+}
 
+void Physics::publishCollisions()
+{
+	// core could be copied over or released since snapshot
+	auto stillValid = [](const PreparedCollider& prepared)
 	{
-		std::lock_guard notifyLock(GlobalSynchronizaion::physics.notifyMutex);
+		return !prepared.core->released && prepared.core->version == prepared.coreVersion;
+	};
 
-		GlobalSynchronizaion::physics.cleanedUp.store(true);
-		GlobalSynchronizaion::main_cv.notify_one();
+	for (uint32_t index = 0; index < m_preparedCount; ++index)
+	{
+		const auto& prepared = m_preparedColliders[index];
+		if (!stillValid(prepared))
+			continue;
+
+		// core was stamped when its object is listed already
+		const uint64_t stamp = (m_queryFrame << 32) | (index + 1);
+
+		prepared.source->clearCollisions();
+		for (const auto& otherIndex : m_collisionResults[index])
+		{
+			const auto& other = m_preparedColliders[otherIndex];
+			if (!stillValid(other))
+				continue;
+
+			auto& otherCore = *other.core;
+			if (otherCore.collisionStamp == stamp)
+			{
+				prepared.source->m_currentlyInCollision[otherCore.collisionEntry].tags |= other.collider.m_tags;
+				continue;
+			}
+
+			otherCore.collisionStamp = stamp;
+			otherCore.collisionEntry = prepared.source->addCollision(otherCore.pOwner, other.collider.m_tags);
+		}
 	}
 }
 
+void Physics::releaseCores()
+{
+	for (auto& releasedCore : m_releasedPhysicsComponentCores)
+	{
+		const auto version = releasedCore->version;
+		const auto colliders = releasedCore->colliders;
+
+		*releasedCore = {};
+		releasedCore->colliders = colliders;
+		std::fill_n(colliders, Settings::PhysicsComponentCore::colliderSlots, Collider2D());
+		releasedCore->version = version + 1;
+		m_physicsComponentCores.push(releasedCore);
+	}
+	m_releasedPhysicsComponentCores.clear();
+}
+
 void Physics::prepareFrame()
 {
-	// first count them
-	uint32_t canBeDetectedCount = 0;
-	uint32_t canDetectcount = 0;
-	for (const auto& activeCore : m_activePhysicsComponentCores)
+	// first count them, every core gets its range of prepared colliders
+	uint32_t colliderCount = 0;
+	m_preparedOffsets.resize(m_activePhysicsComponentCores.size());
+	for (uint32_t index = 0; index < m_activePhysicsComponentCores.size(); ++index)
 	{
+		const auto& activeCore = m_activePhysicsComponentCores[index];
+		m_preparedOffsets[index] = colliderCount;
+
 		// skpi non active cores
 		if (!activeCore->active)
 			continue;
 
-		// divide
-		for (const auto& [_ ,collider]: activeCore->collider2Ds)
-		{
-			if (collider.hasSelfTags())
-				++canBeDetectedCount;
-			if (collider.hasOtherTags())
-				++canDetectcount;
-		}
+		colliderCount += activeCore->getColliderCount();
 	}
 
 	{
 		// clean from previous
-		m_preparedColliders.canBeDetecdedByOthers.clear();
-		m_preparedColliders.canDetectOthers.clear();
-
-		// prepare space
-		if (m_preparedColliders.canBeDetecdedByOthers.size() < canBeDetectedCount)
-			m_preparedColliders.canBeDetecdedByOthers.resize(canBeDetectedCount);
-		if (m_preparedColliders.canDetectOthers.size() < canDetectcount)
-			m_preparedColliders.canDetectOthers.resize(canDetectcount);
+		m_colliderGroups.canBeDetecdedByOthers.clear();
+		m_colliderGroups.canDetectOthers.clear();
+
+		// prepare space, copies keep their capacity between frames
+		if (m_preparedColliders.size() < colliderCount)
+			m_preparedColliders.resize(colliderCount);
+		if (m_collisionResults.size() < colliderCount)
+			m_collisionResults.resize(colliderCount);
 	}
 
-	// iterators
-	auto canBeDetecdedByOthersIt = m_preparedColliders.canBeDetecdedByOthers.begin();
-	auto canDetectOthersIt = m_preparedColliders.canDetectOthers.begin();
+	// snapshot components, ranges dont overlap so cores can be copied in parallel
+	App::jobSystem.parallelFor(static_cast<uint32_t>(m_activePhysicsComponentCores.size()), [this](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t index = begin; index < end; ++index)
+			{
+				const auto& activeCore = m_activePhysicsComponentCores[index];
+				if (!activeCore->active)
+					continue;
+
+				uint32_t preparedIndex = m_preparedOffsets[index];
+				activeCore->forEachCollider([&](uint32_t slot, Collider2D& collider)
+					{
+						// only colliders some test may need get their shape, copy then gets it ready
+						if (collider.hasSelfTags() || collider.hasOtherTags())
+							collider.updateWorldShape();
+
+						auto& prepared = m_preparedColliders[preparedIndex++];
+						prepared.core = activeCore;
+						prepared.coreVersion = activeCore->version;
+						prepared.poolIndex = getPoolIndex(activeCore, slot);
+						prepared.source = &collider;
+						prepared.collider = collider;
+						prepared.collider.clearCollisions();
+					});
+			}
+		});
+	m_preparedCount = colliderCount;
+
+	// categorize
+	for (uint32_t index = 0; index < m_preparedCount; ++index)
+	{
+		const auto& collider = m_preparedColliders[index].collider;
+
+		if (collider.hasSelfTags())
+			m_colliderGroups.canBeDetecdedByOthers.push_back(index);
+		if (collider.hasOtherTags())
+			m_colliderGroups.canDetectOthers.push_back(index);
+	}
 
-	// reset, add and categorize components
-	for (auto& activeCore : m_activePhysicsComponentCores)
+	// goo to keep them sorted
+	auto byTags = [this](uint32_t first, uint32_t second)
 	{
-		// skpi non active cores
-		if (!activeCore->active)
+		return m_preparedColliders[first].collider.m_tags < m_preparedColliders[second].collider.m_tags;
+	};
+	std::sort(m_colliderGroups.canBeDetecdedByOthers.begin(), m_colliderGroups.canBeDetecdedByOthers.end(), byTags);
+	std::sort(m_colliderGroups.canDetectOthers.begin(), m_colliderGroups.canDetectOthers.end(), byTags);
+
+	prepareBroadPhase();
+}
+
+void Physics::prepareBroadPhase()
+{
+	// tags someone is actually looking for
+	uint32_t detectedTags = 0;
+	for (const auto& index : m_colliderGroups.canDetectOthers)
+		detectedTags |= m_preparedColliders[index].collider.m_otherTags;
+
+	// stamps of previous frame can not match any more
+	++m_queryFrame;
+
+	if (m_broadPhase != m_nextBroadPhase)
+	{
+		m_grid.clear();
+		m_sweepAndPrune.clear();
+		std::fill(std::begin(m_sweepProxies), std::end(m_sweepProxies), SweepProxy());
+		m_proxyPoolIndices.clear();
+		m_broadPhase = m_nextBroadPhase;
+	}
+
+	if (m_broadPhase == BroadPhase::GRID)
+		prepareGrid(detectedTags);
+	else
+		prepareSweepAndPrune(detectedTags);
+}
+
+void Physics::prepareGrid(uint32_t detectedTags)
+{
+	m_grid.clear();
+	for (const auto& index : m_colliderGroups.canBeDetecdedByOthers)
+	{
+		const auto& collider = m_preparedColliders[index].collider;
+
+		// nobody would test it anyway
+		if (!compatibleTags(collider.m_tags, detectedTags))
 			continue;
 
-		for (auto& [_, collider] : activeCore->collider2Ds)
-		{
-			// reset the colider
-			collider.clearCollisions();
+		const auto boundingBox = collider.getBoundingBox();
+		m_grid.insert(index, boundingBox.min, boundingBox.max);
+	}
+}
 
-			// assign
-			AssociatedCollider associatedCollider = { activeCore->pOwner, &collider };
+void Physics::prepareSweepAndPrune(uint32_t detectedTags)
+{
+	// detectors need proxy too, they find candidates in their pairs
+	m_preparedProxies.resize(m_preparedCount);
+	for (uint32_t index = 0; index < m_preparedCount; ++index)
+	{
+		const auto& prepared = m_preparedColliders[index];
+		const auto& collider = prepared.collider;
+		if (!collider.hasOtherTags() && !compatibleTags(collider.m_tags, detectedTags))
+			continue;
 
-			if (collider.hasSelfTags())
-				*canBeDetecdedByOthersIt++ = associatedCollider;
-			if (collider.hasOtherTags())
-				*canDetectOthersIt++ = associatedCollider;
+		const auto boundingBox = collider.getBoundingBox();
+		auto& sweepProxy = m_sweepProxies[prepared.poolIndex];
+		if (sweepProxy.proxy == noProxy)
+		{
+			sweepProxy.proxy = m_sweepAndPrune.insert(boundingBox.min, boundingBox.max);
+			if (m_proxyPoolIndices.size() <= sweepProxy.proxy)
+			{
+				m_proxyPoolIndices.resize(sweepProxy.proxy + 1, noProxy);
+				m_proxyColliders.resize(sweepProxy.proxy + 1);
+			}
+			m_proxyPoolIndices[sweepProxy.proxy] = prepared.poolIndex;
 		}
+		else
+		{
+			m_sweepAndPrune.update(sweepProxy.proxy, boundingBox.min, boundingBox.max);
+		}
+		sweepProxy.frame = m_queryFrame;
+
+		m_proxyColliders[sweepProxy.proxy] = index;
+		m_preparedProxies[index] = sweepProxy.proxy;
 	}
 
-	// goo to keep them sorted
-	std::sort(m_preparedColliders.canBeDetecdedByOthers.begin(), m_preparedColliders.canBeDetecdedByOthers.end());
-	std::sort(m_preparedColliders.canDetectOthers.begin(), m_preparedColliders.canDetectOthers.end());
+	// colliders gone since last frame, or no longer in broadphase
+	for (uint32_t proxy = 0; proxy < m_proxyPoolIndices.size(); ++proxy)
+	{
+		const uint32_t poolIndex = m_proxyPoolIndices[proxy];
+		if (poolIndex == noProxy || m_sweepProxies[poolIndex].frame == m_queryFrame)
+			continue;
+
+		m_sweepAndPrune.remove(proxy);
+		m_sweepProxies[poolIndex].proxy = noProxy;
+		m_proxyPoolIndices[proxy] = noProxy;
+	}
+
+	m_sweepAndPrune.commit();
 }
 
 void Physics::updateCollisions()
 {
-	for (auto& [firstOwner, firstCollider] :m_preparedColliders.canDetectOthers)
-	{
-		for (auto& [secondOwner, secondCollider] : m_preparedColliders.canBeDetecdedByOthers)
+	for (uint32_t index = 0; index < m_preparedCount; ++index)
+		m_collisionResults[index].clear();
+
+	std::atomic<uint32_t> testedPairs = 0;
+	std::atomic<uint32_t> acceptedPairs = 0;
+
+	// every detector writes only its own results, pairs detecting
+	// each other are found from both sides
+	const auto& canDetect = m_colliderGroups.canDetectOthers;
+	App::jobSystem.parallelFor(static_cast<uint32_t>(canDetect.size()), [&](uint32_t begin, uint32_t end)
 		{
-			// dont try collision with same object
-			if (firstOwner == secondOwner)
-				continue;
+			// last query each candidate was visited in, filters duplicates from grid
+			static thread_local std::vector<uint64_t> queryStamps;
+			if (queryStamps.size() < m_preparedCount)
+				queryStamps.resize(m_preparedCount, 0);
 
-			// check if we already collided with
-			if(firstCollider->alreadyInCollisionWith(secondCollider))
-				continue;
+			// rectangle pairs wait here and are tested together
+			Collider::RectangleBatch rectangleBatch;
+			uint32_t batchedIndices[Collider::RectangleBatch::capacity];
 
-			//set first
-			bool collided = false;
-			if (firstCollider->canCollideWith(*secondCollider))
+			Statistics statistics;
+			for (uint32_t detectorPosition = begin; detectorPosition < end; ++detectorPosition)
 			{
-				collided = firstCollider->collidesWith(*secondCollider);
-				if (collided)
-					firstCollider->addCollision(secondCollider, secondOwner);
+				const uint64_t queryStamp = (m_queryFrame << 32) | (detectorPosition + 1);
+
+				const auto detectorIndex = canDetect[detectorPosition];
+				const auto& detector = m_preparedColliders[detectorIndex];
+				auto& detectorResults = m_collisionResults[detectorIndex];
+				auto testBatch = [&]()
+				{
+					bool overlays[Collider::RectangleBatch::capacity];
+					Collider::rectanglesOverlay(detector.collider.m_collisionRectangle, rectangleBatch, overlays);
+
+					for (uint32_t place = 0; place < rectangleBatch.count; ++place)
+					{
+						if (!overlays[place])
+							continue;
+
+						++statistics.acceptedPairs;
+						detectorResults.push_back(batchedIndices[place]);
+					}
+					rectangleBatch.count = 0;
+				};
+				auto testCandidate = [&](uint32_t candidateIndex)
+				{
+					const auto& candidate = m_preparedColliders[candidateIndex];
+
+					// dont try collision with same object
+					if (detector.core == candidate.core)
+						return;
+
+					if (detector.collider.canCollideWith(candidate.collider))
+					{
+						++statistics.testedPairs;
+
+						if (detector.collider.m_isRectangle && candidate.collider.m_isRectangle)
+						{
+							batchedIndices[rectangleBatch.count] = candidateIndex;
+							rectangleBatch.push(candidate.collider.m_collisionRectangle);
+							if (rectangleBatch.count == Collider::RectangleBatch::capacity)
+								testBatch();
+						}
+						else if (detector.collider.collidesWith(candidate.collider))
+						{
+							++statistics.acceptedPairs;
+							detectorResults.push_back(candidateIndex);
+						}
+					}
+				};
+
+				if (m_broadPhase == BroadPhase::SWEEP_AND_PRUNE)
+				{
+					// pairs are unique, no filtering needed
+					for (const auto& proxy : m_sweepAndPrune.getOverlaps(m_preparedProxies[detectorIndex]))
+						testCandidate(m_proxyColliders[proxy]);
+				}
+				else
+				{
+					const auto boundingBox = detector.collider.getBoundingBox();
+					m_grid.query(boundingBox.min, boundingBox.max, [&](uint32_t candidateIndex)
+						{
+							// cell overlap may return same candidate more times
+							if (queryStamps[candidateIndex] == queryStamp)
+								return;
+							queryStamps[candidateIndex] = queryStamp;
+
+							testCandidate(candidateIndex);
+						});
+				}
+
+				if (rectangleBatch.count != 0)
+					testBatch();
 			}
 
-			// check if second also looks for same collison so we set it too
-			if (collided)
-			{
-				if (secondCollider->canCollideWith(*firstCollider))
-					secondCollider->addCollision(firstCollider, firstOwner);
-			}
-		}
-	}
+			testedPairs.fetch_add(statistics.testedPairs);
+			acceptedPairs.fetch_add(statistics.acceptedPairs);
+		});
+
+	m_statistics.testedPairs = testedPairs.load();
+	m_statistics.acceptedPairs = acceptedPairs.load();
+}
+
+uint32_t Physics::getPoolIndex(pPhysicsComponentCore core, uint32_t slot) const
+{
+	return static_cast<uint32_t>(core - m_physicsComponentCoreData) * Settings::PhysicsComponentCore::colliderSlots + slot;
 }
 
 uint32_t Physics::createTagFlag(std::string tagName)
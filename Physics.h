@@ -3,17 +3,38 @@
 #include "PhysicsInfo.h"
 #include "PhysicsComponent.h"
 #include "GraphicsComponent.h"
+#include "UniformGrid.h"
+#include "SweepAndPrune.h"
 
 #include <stack>
 #include <unordered_map>
+#include <mutex>
 
 class VulkanBase;
 class Physics
 {
 public:
-	void run();
+	struct Statistics
+	{
+		// pairs which passed broadphase and were tested
+		uint32_t testedPairs = 0;
+		// pairs which actually collided
+		uint32_t acceptedPairs = 0;
+	};
+	// grid is built again every frame, sweep and prune keeps pairs between frames
+	enum class BroadPhase
+	{
+		GRID,
+		SWEEP_AND_PRUNE
+	};
+
 	void initialize();
-	void mainLoop();
+	void cleanUp();
+
+	// called from main while no collision job runs, publishes last results and takes new snapshot
+	void swapFrame();
+	// works only with snapshot taken on last frame swap, runs as job
+	void updateCollisions();
 
 	pPhysicsComponentCore createPhysicsComponentCore();
 	void copyPhysicsComponentCore(const pPhysicsComponentCore& copyPhysicsCore, pPhysicsComponentCore& destinationPhysicsCore);
@@ -22,40 +43,89 @@ public:
 
 	uint32_t getTagsFlag(const std::vector<std::string>& tagNames);
 	uint32_t getTagFlag(const std::string& tagName);
+	uint32_t getColliderSlot(const std::string& colliderName);
 	bool compatibleTags(uint32_t firstFlags, uint32_t secondFlags) const;
+
+	Statistics getStatistics() const;
+
+	// takes effect on next frame swap
+	void setBroadPhase(BroadPhase broadPhase);
+	BroadPhase getBroadPhase() const;
 private:
 	pPhysicsComponentCore getPhysicsComponentCore();
 
 	void prepareResources();
 	void destroyResourcces();
 
+	void publishCollisions();
+	void releaseCores();
 	void prepareFrame();
-	void updateCollisions();
+	void prepareBroadPhase();
+	void prepareGrid(uint32_t detectedTags);
+	void prepareSweepAndPrune(uint32_t detectedTags);
 
 	uint32_t createTagFlag(std::string tagName);
+	// place of collider in pool
+	uint32_t getPoolIndex(pPhysicsComponentCore core, uint32_t slot) const;
 	
 	pPhysicsComponentCore m_physicsComponentCoreData;
 	uint32_t m_physicsComponentCoreCount;
+	// colliders of every core in its slots, core after core
+	Collider2D* m_colliderData;
 	std::stack<pPhysicsComponentCore>  m_physicsComponentCores;
 
 	std::vector<pPhysicsComponentCore> m_activePhysicsComponentCores;
+	// snapshot may still point to them, so they go back to pool on frame swap
+	std::vector<pPhysicsComponentCore> m_releasedPhysicsComponentCores;
 	std::unordered_map<std::string, uint32_t> m_tagFlags;
+	std::unordered_map<std::string, uint32_t> m_colliderSlots;
+	// tags and slots are looked up from simulation jobs
+	std::mutex m_tagMutex;
 
-	struct AssociatedCollider
+	struct PreparedCollider
 	{
-		SimulationObject* simObject;
-		Collider2D* collider;
-
-		// sorti via collider tags
-		bool operator<(const AssociatedCollider& other) const
-		{
-			return collider->m_tags < other.collider->m_tags;
-		}
+		pPhysicsComponentCore core = nullptr;
+		uint32_t coreVersion = 0;
+		uint32_t poolIndex = 0;
+		// live collider, touched only on frame swap
+		Collider2D* source = nullptr;
+		// copy the collision jobs work with
+		Collider2D collider;
 	};
+	std::vector<PreparedCollider> m_preparedColliders;
+	uint32_t m_preparedCount = 0;
+	// first prepared collider of each active core
+	std::vector<uint32_t> m_preparedOffsets;
+	// indices to prepared colliders
 	struct
 	{
-		std::vector<AssociatedCollider> canBeDetecdedByOthers;
-		std::vector<AssociatedCollider> canDetectOthers;
-	} m_preparedColliders;
-};
+		std::vector<uint32_t> canBeDetecdedByOthers;
+		std::vector<uint32_t> canDetectOthers;
+	} m_colliderGroups;
+	// back buffer, indices of prepared colliders each one collides with
+	std::vector<std::vector<uint32_t>> m_collisionResults;
 
+	BroadPhase m_broadPhase = BroadPhase::GRID;
+	BroadPhase m_nextBroadPhase = BroadPhase::GRID;
+	// holds indices to prepared colliders
+	UniformGrid m_grid;
+	SweepAndPrune m_sweepAndPrune;
+	// pool colliders keep their proxy while they stay in broadphase
+	static constexpr uint32_t noProxy = UINT32_MAX;
+	struct SweepProxy
+	{
+		uint32_t proxy = noProxy;
+		uint64_t frame = 0;
+	};
+	std::vector<SweepProxy> m_sweepProxies;
+	// proxy of each prepared collider and prepared collider of each proxy
+	std::vector<uint32_t> m_preparedProxies;
+	std::vector<uint32_t> m_proxyColliders;
+	// pool collider of each proxy, to find ones gone from broadphase
+	std::vector<uint32_t> m_proxyPoolIndices;
+	// high half of query stamps, so per thread stamps need no reset
+	uint64_t m_queryFrame = 0;
+
+	Statistics m_statistics;
+	Statistics m_publishedStatistics;
+};
@@ -2,9 +2,10 @@
 #include "GlobalObjects.h"
 
 
-Collider2D& PhysicsComponent::createCollider(const std::string& name)
+Collider2D& PhysicsComponent::createCollider(uint32_t slot)
 {
-	auto& newCollider = m_core->collider2Ds[name];
+	m_core->usedSlots |= 1 << slot;
+	auto& newCollider = m_core->colliders[slot];
 
 	// setup
 	newCollider.setPosition(m_position);
@@ -13,22 +14,35 @@ Collider2D& PhysicsComponent::createCollider(const std::string& name)
 	return newCollider;
 }
 
-Collider2D& PhysicsComponent::getCollider(const std::string& name)
+Collider2D& PhysicsComponent::createCollider(const std::string& name)
+{
+	return createCollider(App::physics.getColliderSlot(name));
+}
+
+Collider2D& PhysicsComponent::getCollider(uint32_t slot)
 {
-	auto newCollider = m_core->collider2Ds.find(name);
-	if (newCollider == m_core->collider2Ds.end())
-		throw std::runtime_error("Trying to accses collider with name " + name + " that wasnt created previously!");
+	if (!m_core->hasCollider(slot))
+		throw std::runtime_error("Trying to accses collider in slot " + std::to_string(slot) + " that wasnt created previously!");
 
-	return newCollider->second;
+	return m_core->colliders[slot];
 }
 
-const Collider2D& PhysicsComponent::getCollider(const std::string& name) const 
+const Collider2D& PhysicsComponent::getCollider(uint32_t slot) const
+{
+	if (!m_core->hasCollider(slot))
+		throw std::runtime_error("Trying to accses collider in slot " + std::to_string(slot) + " that wasnt created previously!");
+
+	return m_core->colliders[slot];
+}
+
+Collider2D& PhysicsComponent::getCollider(const std::string& name)
 {
-	const auto newCollider = m_core->collider2Ds.find(name);
-	if (newCollider == m_core->collider2Ds.end())
-		throw std::runtime_error("Trying to accses collider with name " + name + " that wasnt created previously!");
+	return getCollider(App::physics.getColliderSlot(name));
+}
 
-	return newCollider->second;
+const Collider2D& PhysicsComponent::getCollider(const std::string& name) const 
+{
+	return getCollider(App::physics.getColliderSlot(name));
 }
 
 PhysicsComponent::PhysicsComponent()
@@ -138,14 +152,26 @@ bool PhysicsComponent::isActive() const
 	return m_core->active;
 }
 
+bool PhysicsComponentCore::hasCollider(uint32_t slot) const
+{
+	return usedSlots & (1 << slot);
+}
+
+uint32_t PhysicsComponentCore::getColliderCount() const
+{
+	uint32_t count = 0;
+	for (uint32_t slots = usedSlots; slots != 0; slots &= slots - 1)
+		++count;
+
+	return count;
+}
+
 void PhysicsComponentCore::setPosition(const glm::vec3& position)
 {
-	for (auto& [_, collider] : collider2Ds)
-		collider.setPosition(position);
+	forEachCollider([&](uint32_t, Collider2D& collider) { collider.setPosition(position); });
 }
 
 void PhysicsComponentCore::setRotation(const glm::vec3& rotation)
 {
-	for (auto& [_, collider] : collider2Ds)
-		collider.setRotation(rotation);
+	forEachCollider([&](uint32_t, Collider2D& collider) { collider.setRotation(rotation); });
 }
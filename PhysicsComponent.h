@@ -4,15 +4,38 @@
 #include "PhysicsInfo.h"
 #include "Collider2D.h"
 #include <string>
-#include <unordered_map>
+
+namespace Settings
+{
+	namespace PhysicsComponentCore
+	{
+		// different collider names one object can have
+		constexpr uint32_t colliderSlots = 2;
+	}
+}
 
 class SimulationObject;
 struct PhysicsComponentCore
 {
 	SimulationObject* pOwner = nullptr;
 	bool active = false;
+	// waits for frame swap to return to pool
+	bool released = false;
+	// changes whenever colliders get replaced, so old pointers to them are known invalid
+	uint32_t version = 0;
+	// last collider whose collisions listed this one and its entry there
+	uint64_t collisionStamp = 0;
+	uint32_t collisionEntry = 0;
 
-	std::unordered_map<std::string, Collider2D> collider2Ds;
+	// slots in collider pool of physics, colliders of all cores lie there one after other
+	Collider2D* colliders = nullptr;
+	// bit for every created slot
+	uint32_t usedSlots = 0;
+
+	bool hasCollider(uint32_t slot) const;
+	uint32_t getColliderCount() const;
+	// function(slot, collider) for created ones
+	template<class Function> void forEachCollider(Function&& function);
 
 	void setPosition(const glm::vec3& position);
 	void setRotation(const glm::vec3& rotation);
@@ -22,8 +45,12 @@ using pPhysicsComponentCore = PhysicsComponentCore*;
 class PhysicsComponent
 {
 public:
+	// slots of known names are in ColliderSlots, others are interned by physics
+	Collider2D& createCollider(uint32_t slot);
 	Collider2D& createCollider(const std::string& name);
 
+	Collider2D& getCollider(uint32_t slot);
+	const Collider2D& getCollider(uint32_t slot) const;
 	Collider2D& getCollider(const std::string& name);
 	const Collider2D& getCollider(const std::string& name) const;
 private:
@@ -50,3 +77,12 @@ private:
 	glm::vec3 m_rotation = {};
 };
 
+template<class Function>
+void PhysicsComponentCore::forEachCollider(Function&& function)
+{
+	for (uint32_t slot = 0; slot < Settings::PhysicsComponentCore::colliderSlots; ++slot)
+	{
+		if (hasCollider(slot))
+			function(slot, colliders[slot]);
+	}
+}
@@ -4,6 +4,18 @@
 #include <string>
 #include <optional>
 
+// tags interned by physics on startup, so they need no lookup by name
+namespace PhysicsTags
+{
+	constexpr uint32_t road = 1 << 0;
+}
+
+// collider names interned on startup, slot of collider in its core
+namespace ColliderSlots
+{
+	constexpr uint32_t body = 0;
+}
+
 namespace Info
 {
 	struct PhysicsComponentUpdateTags
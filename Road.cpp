@@ -187,7 +187,7 @@ bool Road::hasBody() const
 bool Road::sitsPointOn(Point point) const
 {
 	//return m_shape.sitsOnShape(point);
-	return getPhysicsComponent().getCollider("BODY").collidesWith(point);
+	return getPhysicsComponent().getCollider(ColliderSlots::body).collidesWith(point);
 }
 
 BasicRoad::RoadType Road::getRoadType() const
@@ -237,7 +237,7 @@ void Road::createLanes()
 
 			Lane leftLane;
 			leftLane.side = Lane::Side::LEFT;
-			leftLane.points = Points(leftLineSegment.rbegin(), leftLineSegment.rend());
+			leftLane.setPoints(Points(leftLineSegment.rbegin(), leftLineSegment.rend()));
 			leftLane.connectsTo = findConnectedRoad(axis.front());
 			leftLane.connectsFrom = findConnectedRoad(axis.back());
 
@@ -249,7 +249,7 @@ void Road::createLanes()
 
 			Lane rightLane;
 			rightLane.side = Lane::Side::RIGHT;
-			rightLane.points = Points(rightLineSegment.begin(), rightLineSegment.end());
+			rightLane.setPoints(Points(rightLineSegment.begin(), rightLineSegment.end()));
 			rightLane.connectsTo = findConnectedRoad(axis.back());
 			rightLane.connectsFrom = findConnectedRoad(axis.front());
 
@@ -392,8 +392,8 @@ void Road::construct(Points creationPoints, const RoadParameters::Parameters& pa
 
 		// physics
 		{
-			auto& bodyCollider = getPhysicsComponent().createCollider("BODY");
-			bodyCollider.setSelfTags({ "ROAD" });
+			auto& bodyCollider = getPhysicsComponent().createCollider(ColliderSlots::body);
+			bodyCollider.setSelfTags(PhysicsTags::road);
 			bodyCollider.setBoundaries(m_shape.getOutline());
 			enablePhysics();
 		}
@@ -287,6 +287,20 @@ const RC::Prototype* RoadCreatorUI::getSelectedPrototype() const
 	return m_selectedPrototype;
 }
 
+bool RoadCreatorUI::selectPrototype(const std::string& name)
+{
+	for (const auto& prototype : m_prototypes)
+	{
+		if (prototype.name == name)
+		{
+			m_selectedPrototype = &prototype;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 RoadCreator::RoadCreator(ObjectManager* objectManager)
 	: BasicCreator(objectManager)
 {
@@ -362,6 +376,38 @@ void RoadCreator::rollBackEvent()
 		m_setPoints.pop_back();
 }
 
+bool RoadCreator::selectPrototype(const std::string& name)
+{
+	return m_ui.selectPrototype(name);
+}
+
+bool RoadCreator::constructRoad(const Points& axisPoints)
+{
+	m_mousePoint.reset();
+	m_setPoints.clear();
+	for (const auto& axisPoint : axisPoints)
+		m_setPoints.push_back(getSittingPoint(axisPoint));
+
+	updateProcessedPoints();
+	updateCreationPoints();
+	constructRoadPrototype();
+
+	const bool constructed = m_processedCurrentPoints.validPoints && m_setPoints.size() > 1;
+	tryToConstructRoad();
+
+	// sink prototype again
+	m_setPoints.clear();
+	m_creationPoints = {};
+	constructRoadPrototype();
+
+	return constructed;
+}
+
+bool RoadCreator::constructSpawner(Point point)
+{
+	return placeSpawner(getSittingPoint(point));
+}
+
 void RoadCreator::setCreatorModeAction()
 {
 	// could be clar points function tho
@@ -439,6 +485,33 @@ void RoadCreator::setPoint()
 		m_setPoints.push_back(m_mousePoint.value());
 }
 
+RC::SittingPoint RoadCreator::getSittingPoint(Point point) const
+{
+	RC::SittingPoint sittingPoint;
+	sittingPoint.point = point;
+
+	// same order as selection, intersections win over roads they overlap
+	BasicRoad* sittingRoad = nullptr;
+	for (auto& road : m_pObjectManager->m_roads.data)
+	{
+		if (road.sitsPointOn(point))
+			sittingRoad = &road;
+	}
+	for (auto& intersection : m_pObjectManager->m_intersections.data)
+	{
+		if (intersection.sitsPointOn(point))
+			sittingRoad = &intersection;
+	}
+
+	if (sittingRoad)
+	{
+		sittingPoint.road = sittingRoad;
+		sittingPoint.point = sittingRoad->getAxisPoint(point);
+	}
+
+	return sittingPoint;
+}
+
 /*/
 void RoadCreator::validateCurrentShape()
 {
@@ -565,27 +638,32 @@ void RoadCreator::tryToConstructSpawner()
 	// just to make sure
 	m_setPoints.clear();
 
-	if (m_mousePoint)
-	{
-		// we create only on road end
-		if (m_mousePoint->road && App::input.mouse.pressedButton(GLFW_MOUSE_BUTTON_LEFT))
-		{
-			if (auto road = dynamic_cast<Road*>(m_mousePoint->road.value()))
-			{
-				auto axisPoint = road->getAxisPoint(m_mousePoint.value().point);
-				auto endPoint = road->getClosestEndPoint(axisPoint);
+	if (m_mousePoint && App::input.mouse.pressedButton(GLFW_MOUSE_BUTTON_LEFT))
+		placeSpawner(m_mousePoint.value());
+}
 
-				if (road->canConnect(endPoint))
-				{
-					CarSpawner cSpawner;
-					cSpawner.setActive(true);
-					cSpawner.construct(road, endPoint);
+bool RoadCreator::placeSpawner(const RC::SittingPoint& sittingPoint)
+{
+	// we create only on road end
+	if (!sittingPoint.road)
+		return false;
 
-					m_pObjectManager->m_carSpawners.add(cSpawner);
-				}
-			}
-		}
-	}
+	auto road = dynamic_cast<Road*>(sittingPoint.road.value());
+	if (!road)
+		return false;
+
+	auto axisPoint = road->getAxisPoint(sittingPoint.point);
+	auto endPoint = road->getClosestEndPoint(axisPoint);
+
+	if (!road->canConnect(endPoint))
+		return false;
+
+	CarSpawner cSpawner;
+	cSpawner.setActive(true);
+	cSpawner.construct(road, endPoint);
+
+	m_pObjectManager->m_carSpawners.add(cSpawner);
+	return true;
 }
 
 void RoadCreator::tryToDestroyRoad()
@@ -605,6 +683,7 @@ void RoadCreator::tryToDestroyRoad()
 			auto road = dynamic_cast<Road*>(curRoad);
 			auto cut = road->getCut(Shape::AxisPoint(curPoint));
 			auto product = road->cut(cut);
+			road->markLanesDirty();
 
 			if (!road->hasBody())
 				m_pObjectManager->m_roads.remove(road);
@@ -635,7 +714,10 @@ void RoadCreator::tryToDestroyRoad()
 
 			//rebuild connected
 			for (auto& connectedRoad : connectedRoads)
+			{
 				connectedRoad->reconstruct();
+				connectedRoad->markLanesDirty();
+			}
 		}
 		else if (curRoad->getRoadType() == BasicRoad::RoadType::CAR_SPAWNER)
 		{
@@ -653,6 +735,7 @@ void RoadCreator::checkIntersections()
 	auto& intersections = m_pObjectManager->m_intersections.data;
 	for (auto intIter = intersections.begin(); intIter != intersections.end();)
 	{
+		// rebuilds only after losing connection, that marked it already
 		intIter->checkShapesAndRebuildIfNeeded();
 		if (!intIter->hasBody())
 		{
@@ -660,6 +743,7 @@ void RoadCreator::checkIntersections()
 			if (dissassembledRoads.size() == 2)
 			{
 				dissassembledRoads[0]->mergeWith(*dissassembledRoads[1]);
+				dissassembledRoads[0]->markLanesDirty();
 				m_pObjectManager->m_roads.remove(dissassembledRoads[1]);
 			}
 
@@ -716,6 +800,8 @@ void RoadCreator::handleConstruction(Road newRoad, std::vector<RC::PointRoadPair
 	Road* useRoad = &newRoad;
 	for (auto& [point, bRoad] : connectPoints)
 	{
+		// shape changes even when connections stay
+		bRoad->markLanesDirty();
 		if (bRoad->getRoadType() == BasicRoad::RoadType::ROAD)
 		{
 			auto road = dynamic_cast<Road*>(bRoad);
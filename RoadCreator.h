@@ -119,6 +119,7 @@ public:
 	bool makeSpawners() const;
 	bool constructRoads() const;
 	const RC::Prototype* getSelectedPrototype() const;
+	bool selectPrototype(const std::string& name);
 
 private:
 	bool m_doCurves = false;
@@ -146,6 +147,11 @@ public:
 	void handleDestroying();
 	void rollBackEvent();
 
+	// scripted construction, goes through the same steps as placing points with mouse
+	bool selectPrototype(const std::string& name);
+	bool constructRoad(const Points& axisPoints);
+	bool constructSpawner(Point point);
+
 protected:
 	virtual void setCreatorModeAction() override;
 	virtual void setActiveAction() override;
@@ -165,9 +171,11 @@ private:
 	};
 	RC::ProcSitPts processSittingPoints(const std::vector<RC::SittingPoint> sittingPoints) const;
 	void setPoint();
+	RC::SittingPoint getSittingPoint(Point point) const;
 	void constructRoadPrototype();
 	void tryToConstructRoad();
 	void tryToConstructSpawner();
+	bool placeSpawner(const RC::SittingPoint& sittingPoint);
 
 	void tryToDestroyRoad();
 	void checkIntersections();
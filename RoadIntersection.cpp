@@ -6,6 +6,8 @@
 #include "Road.h"
 
 #include <numeric>
+#include <limits>
+#include <optional>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -431,7 +433,7 @@ void RoadIntersection::setUpShape()
 
 	setupModel(mInfo, true);
 
-	getPhysicsComponent().createCollider("BODY").setBoundaries(m_outlinePoints);
+	getPhysicsComponent().createCollider(ColliderSlots::body).setBoundaries(m_outlinePoints);
 }
 
 void RoadIntersection::checkShapesAndRebuildIfNeeded()
@@ -651,7 +653,7 @@ void RoadIntersection::createLanes()
 				std::copy(std::begin(shapeOneLane), std::end(shapeOneLane), std::back_inserter(pathPoints));
 				// omit that one common point
 				std::copy(std::begin(shapeTwoLane) + 1, std::end(shapeTwoLane), std::back_inserter(pathPoints));
-				newLane.points = pathPoints;
+				newLane.setPoints(pathPoints);
 
 				newLane.side = Lane::Side::RIGHT;
 
@@ -660,6 +662,93 @@ void RoadIntersection::createLanes()
 			}
 		}
 	}
+
+	createLaneConflicts();
+}
+
+const std::vector<RoadIntersection::LaneConflict>& RoadIntersection::getLaneConflicts() const
+{
+	return m_laneConflicts;
+}
+
+// closer to span than conflict distance, stops at first close segment
+static bool isCloseToSpan(const Points& points, const ArcLength::Span& span, const Point& point)
+{
+	const glm::vec2 flatPoint(point.x, point.z);
+
+	return ArcLength::anyOfSegments(points, span, [&](const Point& start, const Point& end)
+		{
+			const glm::vec2 segmentStart(start.x, start.z);
+			const glm::vec2 segment = glm::vec2(end.x, end.z) - segmentStart;
+			const float segmentLengthSquared = glm::dot(segment, segment);
+
+			const float progress = segmentLengthSquared > 0.0f ?
+				glm::clamp(glm::dot(flatPoint - segmentStart, segment) / segmentLengthSquared, 0.0f, 1.0f) : 0.0f;
+			return glm::length(flatPoint - (segmentStart + segment * progress)) < Settings::RoadIntersection::conflictDistance;
+		});
+}
+
+// first and last arc length of lane where other lane between its given arc lengths is close
+static std::optional<std::pair<float, float>> findLaneOverlap(const Lane& lane, const Lane& otherLane, float otherStart, float otherEnd)
+{
+	// graph leaves such lanes out too
+	if (lane.points.size() < 2 || otherLane.points.size() < 2)
+		return std::nullopt;
+
+	constexpr float step = Settings::RoadIntersection::conflictSampleStep;
+	const float length = lane.length();
+	const uint32_t sampleCount = static_cast<uint32_t>(std::ceil(length / step)) + 1;
+	const auto otherSpan = ArcLength::spanBetween(otherLane.points, otherLane.distances, otherStart, otherEnd);
+
+	std::optional<std::pair<float, float>> overlap;
+	for (uint32_t sample = 0; sample < sampleCount; ++sample)
+	{
+		const float distance = std::min(sample * step, length);
+		if (!isCloseToSpan(otherLane.points, otherSpan, lane.sampleAt(distance).point))
+			continue;
+
+		if (!overlap)
+			overlap = std::make_pair(distance, distance);
+		overlap->second = distance;
+	}
+
+	// closeness between samples is missed otherwise
+	if (overlap)
+	{
+		overlap->first = std::max(overlap->first - step, 0.0f);
+		overlap->second = std::min(overlap->second + step, length);
+	}
+
+	return overlap;
+}
+
+void RoadIntersection::createLaneConflicts()
+{
+	m_laneConflicts.clear();
+
+	const auto& lanes = m_lanes[Lane::Side::RIGHT];
+	for (uint32_t lane = 0; lane < lanes.size(); ++lane)
+	{
+		for (uint32_t otherLane = lane + 1; otherLane < lanes.size(); ++otherLane)
+		{
+			const auto overlap = findLaneOverlap(lanes[lane], lanes[otherLane], 0.0f, lanes[otherLane].length());
+			if (!overlap)
+				continue;
+			// other lane can come close only to part of lane which came close to it
+			const auto otherOverlap = findLaneOverlap(lanes[otherLane], lanes[lane], overlap->first, overlap->second);
+			if (!otherOverlap)
+				continue;
+
+			LaneConflict conflict;
+			conflict.lane = lane;
+			conflict.otherLane = otherLane;
+			conflict.start = overlap->first;
+			conflict.end = overlap->second;
+			conflict.otherStart = otherOverlap->first;
+			conflict.otherEnd = otherOverlap->second;
+			m_laneConflicts.push_back(conflict);
+		}
+	}
 }
 
 bool RoadIntersection::canSwitchLanes() const
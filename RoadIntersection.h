@@ -7,6 +7,16 @@
 #include <array>
 #include <set>
 
+namespace Settings
+{
+	namespace RoadIntersection
+	{
+		// lanes closer than this get cars touching, little more than car width
+		constexpr float conflictDistance = 2.5f;			// meters
+		// lanes are compared at points this far apart
+		constexpr float conflictSampleStep = 0.25f;			// meters
+	}
+}
 
 class Road;
 class RoadIntersection
@@ -34,14 +44,31 @@ public:
 
 	uint32_t directionCount() const;
 
+	// two lanes cross or merge, only one of them may have cars there at a time
+	struct LaneConflict
+	{
+		// indices of right lanes
+		uint32_t lane = 0;
+		uint32_t otherLane = 0;
+		// arc lengths where lanes come close, along each of them
+		float start = 0.0f;
+		float end = 0.0f;
+		float otherStart = 0.0f;
+		float otherEnd = 0.0f;
+	};
+	const std::vector<LaneConflict>& getLaneConflicts() const;
+
 protected:
 	virtual Mesh createLineMesh() override;
 
 private:
+	void createLaneConflicts();
 
 	float m_width = 0;
 	Point m_centre = {};
 	std::vector<SegmentedShape> m_connectShapes;
 	std::vector<Point> m_outlinePoints;
+	// made with lanes
+	std::vector<LaneConflict> m_laneConflicts;
 };
 
@@ -1,50 +1,36 @@
 #pragma once
 #include "BasicRoad.h"
+#include "LaneGraph.h"
 
 #include <vector>
-#include <stack>
+#include <queue>
+#include <limits>
+#include <functional>
 #include <algorithm>
 
-namespace PathFinding
+namespace Settings
 {
-	struct TravellRoad
+	namespace PathFinding
 	{
-		const BasicRoad* road;
-		std::stack<const BasicRoad*> toVisit;
-
-		static TravellRoad createTravellRoad(const BasicRoad* road, const BasicRoad* comesFrom)
-		{
-			TravellRoad travellRoad;
-			travellRoad.road = road;
-
-			for (const auto& connection : road->getConnections())
-			{
-				if (connection.connected != comesFrom)
-					travellRoad.toVisit.emplace(connection.connected);
-			}
-
-			return travellRoad;
-		}
-	};
-	using TravelledRoads = std::vector<TravellRoad>;
+		// added to travel time when car switches lanes on road
+		constexpr float laneSwitchPenalty = 2.0f;		// seconds
+	}
+}
 
-	//using pBasicRoad = BasicRoad*;
+namespace PathFinding
+{
 	using cpBasicRoad = const BasicRoad*;
-	using RoadRoute = std::vector<cpBasicRoad>;
-	using RoadRoutes = std::vector<RoadRoute>;
 
 	struct TravellSegment
 	{
 		cpBasicRoad road = nullptr;
-		Lane lane = {};
-		std::optional<Lane> switchLane;
+		LaneId lane = invalidLaneId;
+		// lane car switches to before leaving road
+		LaneId switchLane = invalidLaneId;
 
-		bool canConnectoTo(const TravellSegment& other)
+		LaneId exitLane() const
 		{
-			if (switchLane)
-				return switchLane->leadsToLane(other.lane);
-			else
-				return lane.leadsToLane(other.lane);
+			return switchLane != invalidLaneId ? switchLane : lane;
 		}
 	};
 	using TravellSegments = std::vector<TravellSegment>;
@@ -52,460 +38,173 @@ namespace PathFinding
 
 	namespace details
 	{
-		static TravellSegments transferRoadRouteToTravellSegments(const RoadRoute& route)
+		// function(lane) for lane itself and lanes car can switch to from it
+		template<class Function> void forEachSwitchableLane(const LaneGraph& laneGraph, LaneId lane, Function&& function)
 		{
-			TravellSegments travellSegments(route.size());
-			std::transform(std::begin(route), std::end(route), std::begin(travellSegments), [](const cpBasicRoad& road)
-				{
-					TravellSegment segment;
-					segment.road = road;
-
-					return segment;
-				});
+			function(lane);
 
-			return travellSegments;
-		}
+			const auto* road = laneGraph.getRoad(lane);
+			if (!road->canSwitchLanes())
+				return;
 
-		static void keepOnlyLanesConnectingTo(std::vector<Lane>& lanes,  cpBasicRoad connectsToRoad)
-		{
-			lanes.erase(std::remove_if(std::begin(lanes), std::end(lanes),
-				[&connectsToRoad](const Lane& lane)
-				{
-					return lane.connectsTo != connectsToRoad;
-				}),
-				lanes.end());
-		}
-
-		static void keepOnlyLanesConnectingFrom(std::vector<Lane>& lanes,  cpBasicRoad connectFromRoad)
-		{
-			lanes.erase(std::remove_if(std::begin(lanes), std::end(lanes),
-				[&connectFromRoad](const Lane& lane)
-				{
-					return lane.connectsFrom != connectFromRoad;
-				}),
-				lanes.end());
-		}
-
-
-		static PathFinding::RoadRoutes startTravellToDestinationAndGetAllRoutes(PathFinding::TravellRoad routeStart, const BasicRoad& destination)
-		{
-			using namespace PathFinding;
-			// here we store routes
-			RoadRoutes routes;
-
-			std::vector<TravellRoad> travelledRoads = { routeStart };
-			TravellRoad* currentTravellRoad = &travelledRoads.back();
-
-			bool foundAllRoutes = false;
-			while (!foundAllRoutes)
+			const auto roadLanes = laneGraph.getRoadLanes(road);
+			for (LaneId otherLane = roadLanes.first; otherLane < roadLanes.last; ++otherLane)
 			{
-				// no more other lanes here, try to go lower level,
-				// we need to retrieve another road
-				if (currentTravellRoad->toVisit.empty())
-				{
-					// if no more or last travelled road (which we would pop)
-					// we have found all of them
-					if (travelledRoads.empty() || travelledRoads.size() <= 1)
-					{
-						foundAllRoutes = true;
-					}
-					else // else get last
-					{
-						travelledRoads.pop_back();
-						currentTravellRoad = &travelledRoads.back();
-					}
-				}
-				else // process current
-				{
-					// get next road to visit
-					cpBasicRoad nextRoad = currentTravellRoad->toVisit.top();
-					currentTravellRoad->toVisit.pop();
-
-					// have we found it?
-					// dont continue, but extract
-					if (nextRoad == &destination)
-					{
-						auto extractRoute = [](const std::vector<TravellRoad>& toExtract)
-						{
-							RoadRoute route;
-							std::transform(std::begin(toExtract), std::end(toExtract), std::back_inserter(route),
-								[](const TravellRoad& travellRoad) { return travellRoad.road; });
-
-							return route;
-						};
-						// add next as well
-						RoadRoute newRoute = extractRoute(travelledRoads);
-						newRoute.emplace_back(nextRoad);
-
-						routes.emplace_back(newRoute);
-					}
-					else // retrieve next
-					{
-						// check if we were on this road before so we wont loop forever
-						bool alreadyTravelled = false;
-						for (const auto& travelledRoad : travelledRoads)
-						{
-							if (travelledRoad.road == nextRoad)
-							{
-								alreadyTravelled = true;
-								break;
-							}
-						}
-
-						if (!alreadyTravelled)
-						{
-							// create road travell point and make it current
-							auto nextTravellRoad = TravellRoad::createTravellRoad(nextRoad, currentTravellRoad->road);
-							currentTravellRoad = &travelledRoads.emplace_back(nextTravellRoad);
-						}
-					}
-				}
+				if (otherLane != lane && laneGraph.areParallel(lane, otherLane))
+					function(otherLane);
 			}
-
-			return routes;
 		}
 
-		// lane is setup
-		static void handleOneRoadSegment(PathFinding::TravellSegments& travellSegments, Lane startLane, Lane endLane)
+		// lane search reached is left by car, entered lane may differ when it switched,
+		// kept between queries so only lanes query reached are reset
+		struct LaneSearch
 		{
-			auto& onlySegment = travellSegments[0];
-
-			// assign and work with it
-			onlySegment.lane = startLane;
-
-			// need to switch lanes
-			if (startLane != endLane)
-				onlySegment.switchLane = endLane;
-		}
-
-		/*
-		* Segment first and second segments need to have
-		* set up lanes 
-		*/
-		static void handleTwoRoadSegments(PathFinding::TravellSegments& travellSegments, Lane startLane, Lane endLane)
-		{
-			auto& startSegment = travellSegments[0];
-			auto& endSegment = travellSegments[1];
-
-			// assign and work with it
-			startSegment.lane = startLane;
-			endSegment.lane = endLane;
-
-			const auto& startRoad = startSegment.road;
-			const auto& endRoad = endSegment.road;
-
-			auto& startSegmentLane = startSegment.lane;
-			auto& endSegmentLane = endSegment.lane;
+			std::vector<float> travelTime;
+			std::vector<LaneId> previousLane;
+			std::vector<LaneId> enteredLane;
+			std::vector<bool> closed;
+			std::vector<LaneId> touched;
 
-			// if theyre not just right
-			// we have to change switch lane in one of segments
-
-			bool segmentsCompatible = startSegmentLane.leadsToLane(endSegmentLane);
-			if(segmentsCompatible)
+			void prepare(uint32_t laneCount)
 			{
-				// start from start
-				if (startSegment.road->canSwitchLanes())
-				{
-					auto possibleRoads = startRoad->getAllLanesConnectingTo(endRoad);
-
-					// extists
-					if (!possibleRoads.empty())
-					{
-						startSegment.switchLane = possibleRoads[0];
-						segmentsCompatible = true;
-					}
-				}
-				// still not compatible
-				if (endSegment.road->canSwitchLanes() && !segmentsCompatible)
-				{
-					auto possibleRoads = endRoad->getAllLanesConnectingFrom(startRoad);
-					// exists
-					if (!possibleRoads.empty())
-					{
-						// we need to make switch lane previokus 
-						// and set lane to possible
-						endSegment.switchLane = endSegment.lane;
-						endSegment.lane = possibleRoads[0];
-						segmentsCompatible = true;
-					}
-				}
+				if (travelTime.size() == laneCount)
+					return;
+
+				travelTime.assign(laneCount, std::numeric_limits<float>::max());
+				previousLane.assign(laneCount, invalidLaneId);
+				enteredLane.assign(laneCount, invalidLaneId);
+				closed.assign(laneCount, false);
+				touched.clear();
 			}
-		}
-
-		/* Checks if this segments 
-		* can connect to next segment
-		* check if lanes are connected and if not
-		* check for next segment wether it can change lane otherwise 
-		* need to roll back
-		* ... 
-		* Can handle end segment too
-		*/
-		static bool segmentLanesConnectingTo(
-			PathFinding::TravellSegment& currentSegment,
-			PathFinding::TravellSegment& nextSegment, 
-			const BasicRoad* nextSegmentsShouldLeadTo)
-		{
-			const auto& currentLane = currentSegment.switchLane ?
-				currentSegment.switchLane.value() : currentSegment.lane;
-
-			// get all roads from next segment which comes from
-			// current's segment road
-			if (currentLane.empty())
-				return false;
-			auto nextSegmentPossibleLanes = nextSegment.road->getSubsequentLanesConnectingFromLane(currentLane);
-			// no possible lanes
-			if (nextSegmentPossibleLanes.empty())
-				return false;
 
-
-			// are we handling end segment
-			if (!nextSegmentsShouldLeadTo)
+			void reset()
 			{
-				// find if we have lane hit
-				auto& nextLane = nextSegment.lane;
-				bool containsSameLane = false;
-				for (const auto& possibleLane : nextSegmentPossibleLanes)
+				for (const auto& lane : touched)
 				{
-					if (nextLane == possibleLane)
-					{
-						containsSameLane = true;
-						break;
-					}
-				}
-
-				// do we have hit?
-				// no need to change
-				if (containsSameLane)
-				{
-					return true;
-				}
-				else // check if we can switch lines
-				{
-					if (nextSegment.road->canSwitchLanes())
-					{
-						nextSegment.switchLane = nextSegmentPossibleLanes[0];
-						return true;
-					}
-					else
-					{
-						return false;
-					}
+					travelTime[lane] = std::numeric_limits<float>::max();
+					previousLane[lane] = invalidLaneId;
+					enteredLane[lane] = invalidLaneId;
+					closed[lane] = false;
 				}
+				touched.clear();
 			}
-			else
-			{
-				// filter them so they only connect to that next road
-				keepOnlyLanesConnectingTo(nextSegmentPossibleLanes, nextSegmentsShouldLeadTo);
+		};
 
-				// if no possible lanes
-				if (nextSegmentPossibleLanes.empty())
-				{
-					return false;
-				}
-				else
-				{
-					//take first possible
-					nextSegment.lane = nextSegmentPossibleLanes[0];
-
-					return true;
-				}
-			}
-		}
-
-		/* Checks if this segments
-		* can connect to next segment
-		* this function supposes that current lane
-		* couldnt change lane
-		* ...
-		* Can handle start segment too
-		*/
-		static bool repairSegmentPathsConnectingFrom(
-			const BasicRoad* previousShouldSegmentConnectsFrom,
-			PathFinding::TravellSegment& previousSegment,
-			PathFinding::TravellSegment& currentSegment)
+		static TravellSegments extractTravellSegments(const LaneGraph& laneGraph, const LaneSearch& search, LaneId endLane)
 		{
-			const auto& currentLane = currentSegment.lane;
-
-			// get all roads from next segment which comes from
-
-			// current's segment road
-			auto previousSegmentPossibleLanes = previousSegment.road->getSubsequentLanesConnectingToLane(currentLane);
-			// no possible lanes
-			if (previousSegmentPossibleLanes.empty())
-				return false;
-
-			// are we on the start
-			if (!previousShouldSegmentConnectsFrom)
+			TravellSegments travellSegments;
+			for (LaneId lane = endLane; lane != invalidLaneId; lane = search.previousLane[lane])
 			{
-				// find if we have lane hit
-				auto& previousLane = previousSegment.lane;
-				bool containsSameLane = false;
-				for (const auto& possibleLane : previousSegmentPossibleLanes)
-				{
-					if (previousLane == possibleLane)
-					{
-						containsSameLane = true;
-						break;
-					}
-				}
+				TravellSegment segment;
+				segment.road = laneGraph.getRoad(lane);
+				segment.lane = search.enteredLane[lane];
+				if (segment.lane != lane)
+					segment.switchLane = lane;
 
-				// do we have hit?
-				// no need to change
-				if (containsSameLane)
-				{
-					return true;
-				}
-				else // check if we can switch lines
-				{
-					if (previousSegment.road->canSwitchLanes())
-					{
-						// take frist possible
-						previousSegment.switchLane = previousSegmentPossibleLanes[0];
-						return true;
-					}
-					else
-					{
-						return false;
-					}
-				}
+				travellSegments.push_back(segment);
 			}
-			else
-			{
-				// filter them so they only connect to that next road
-				keepOnlyLanesConnectingFrom(previousSegmentPossibleLanes, previousShouldSegmentConnectsFrom);
-
-				// if no possible lanes
-				if (previousSegmentPossibleLanes.empty())
-				{
-					return false;
-				}
-				else
-				{
-					//take first possible
-					previousSegment.lane = previousSegmentPossibleLanes[0];
+			std::reverse(std::begin(travellSegments), std::end(travellSegments));
 
-					return true;
-				}
-			}
+			return travellSegments;
 		}
 
-		static void handleMoreThanThreeRoadSegments(PathFinding::TravellSegments& travellSegments, Lane startLane, Lane endLane)
+		// A* with travelTimeOf(lane) as weight, car may switch lanes
+		// on start road only when asked
+		template<class TravelTime> TravellSegments searchRoute(const LaneGraph& laneGraph, LaneId startLane, LaneId endLane,
+			bool estimateRest, bool switchAtStart, TravelTime&& travelTimeOf)
 		{
-			if (travellSegments.size() < 3)
-				throw std::runtime_error("Too few segments to handle");
-
-			// initialize start and end segment
-			{
-				auto& frontSegment = travellSegments.front();
-				auto& backSegment = travellSegments.back();
-
-				// assign and work with it
-				frontSegment.lane = startLane;
-				backSegment.lane = endLane;
-			}
+			if (startLane == invalidLaneId || endLane == invalidLaneId)
+				return {};
 
+			const auto& goalPoint = laneGraph.getPoints(endLane).front();
+			auto estimateRestOf = [&](LaneId lane)
 			{
-				auto currentSegmentIt = travellSegments.begin();
-				auto nextSegmentIt = currentSegmentIt + 1;
+				if (!estimateRest)
+					return 0.0f;
 
-				bool finishedFinding = false;
-				while (!finishedFinding)
-				{
-					bool succesfullySteppedForward;
-					// check for end segment so we pass right arguments
-					if (nextSegmentIt + 1 != travellSegments.end())
-						succesfullySteppedForward =
-							segmentLanesConnectingTo(*currentSegmentIt, *nextSegmentIt, (nextSegmentIt + 1)->road);
-					else 
-						succesfullySteppedForward = 
-							segmentLanesConnectingTo(*currentSegmentIt, *nextSegmentIt, nullptr);
+				return glm::length(goalPoint - laneGraph.getPoints(lane).back()) / Settings::LaneGraph::maxSpeedLimit;
+			};
 
+			static thread_local LaneSearch search;
+			search.prepare(laneGraph.getLaneCount());
+			using QueuedLane = std::pair<float, LaneId>;
+			std::priority_queue<QueuedLane, std::vector<QueuedLane>, std::greater<QueuedLane>> openLanes;
 
-					// repair if not correct
-					if (!succesfullySteppedForward)
+			auto reachLane = [&](LaneId lane, LaneId enteredLane, LaneId previousLane, float travelTime)
+			{
+				if (travelTime >= search.travelTime[lane])
+					return;
+
+				if (search.travelTime[lane] == std::numeric_limits<float>::max())
+					search.touched.push_back(lane);
+				search.travelTime[lane] = travelTime;
+				search.enteredLane[lane] = enteredLane;
+				search.previousLane[lane] = previousLane;
+				openLanes.emplace(travelTime + estimateRestOf(lane), lane);
+			};
+			auto enterLane = [&](LaneId enteredLane, LaneId previousLane, float travelTime)
+			{
+				forEachSwitchableLane(laneGraph, enteredLane, [&](LaneId lane)
 					{
-						if(currentSegmentIt == travellSegments.begin())
-							throw std::runtime_error("Cannot repair this segments");
-
-						// keep going backwards till we have repaired
-						auto previousRepairSegmentIt = currentSegmentIt - 1;
-						auto currentRepairSegmentIt = currentSegmentIt;
-
-						bool finishedRepairing = false;
-						while (!finishedRepairing)
-						{
-							bool succesfullyRepaired;
-							if (previousRepairSegmentIt == travellSegments.begin())
-							{
-								succesfullyRepaired =	repairSegmentPathsConnectingFrom(nullptr, *previousRepairSegmentIt,
-										*currentRepairSegmentIt);
+						const float penalty = lane != enteredLane ? Settings::PathFinding::laneSwitchPenalty : 0.0f;
+						reachLane(lane, enteredLane, previousLane, travelTime + travelTimeOf(lane) + penalty);
+					});
+			};
 
-								if (!succesfullyRepaired)
-									throw std::runtime_error("Couldnt fix travell segments");
-							}
-							else
-							{
-								succesfullyRepaired =	repairSegmentPathsConnectingFrom((previousRepairSegmentIt - 1)->road,
-									*previousRepairSegmentIt, *currentRepairSegmentIt);
-							}
+			if (switchAtStart)
+				enterLane(startLane, invalidLaneId, 0.0f);
+			else
+				reachLane(startLane, startLane, invalidLaneId, travelTimeOf(startLane));
 
-							if (succesfullyRepaired)
-							{
-								finishedRepairing = true;
-							}
-							else
-							{
-								--previousRepairSegmentIt;
-								--currentRepairSegmentIt;
-							}
-						}
-					}
+			TravellSegments travellSegments;
+			while (!openLanes.empty())
+			{
+				const LaneId lane = openLanes.top().second;
+				openLanes.pop();
 
-					// step forward
-					++currentSegmentIt;
-					++nextSegmentIt;
+				// queued more times, first one was the best
+				if (search.closed[lane])
+					continue;
+				search.closed[lane] = true;
 
-					// check if finished
-					finishedFinding = nextSegmentIt == travellSegments.end();
+				if (lane == endLane)
+				{
+					travellSegments = extractTravellSegments(laneGraph, search, endLane);
+					break;
 				}
+
+				for (const auto& nextLane : laneGraph.getSuccessors(lane))
+					enterLane(nextLane, lane, search.travelTime[lane]);
 			}
+
+			search.reset();
+			return travellSegments;
 		}
 	}
 
-
-	static PathFinding::RoadRoutes createRoadRoutes(const BasicRoad& startRoad, const BasicRoad& endRoad)
+	/*
+	* A* over lanes weighted by travel time at speed limit,
+	* straight line to end lane at highest speed limit is
+	* never longer so first route found is fastest one.
+	* Empty when end lane cant be reached.
+	* Without estimate its plain Dijkstra.
+	*/
+	static PathFinding::TravellSegments findRoute(const LaneGraph& laneGraph, LaneId startLane, LaneId endLane,
+		bool estimateRest = true)
 	{
-		if (&startRoad == &endRoad)
-		{
-			return { { &startRoad } };
-		}
-
-		// create start route
-		PathFinding::TravellRoad routeStart =
-			PathFinding::TravellRoad::createTravellRoad(&startRoad, nullptr);
-
-		return details::startTravellToDestinationAndGetAllRoutes(routeStart, endRoad);
+		return details::searchRoute(laneGraph, startLane, endLane, estimateRest, true,
+			[&laneGraph](LaneId lane) { return laneGraph.getTravelTime(lane); });
 	}
 
-	static PathFinding::TravellSegments findLaneOnRoute(const PathFinding::RoadRoute& route, Lane startLane, Lane endLane)
+	/*
+	* Rest of route for car already driving current lane, so it starts
+	* there without switching. Travel times are measured ones, they must
+	* not be lower than at speed limit or estimate would overshoot.
+	*/
+	static PathFinding::TravellSegments findRemainingRoute(const LaneGraph& laneGraph, LaneId currentLane, LaneId endLane,
+		const std::vector<float>& travelTimes)
 	{
-		// no prevention from one route road
-		auto segmentsToTravell = details::transferRoadRouteToTravellSegments(route);
-
-
-		if (segmentsToTravell.size() == 1)
-		{
-			details::handleOneRoadSegment(segmentsToTravell, startLane, endLane);
-		}
-	   	else if (segmentsToTravell.size() == 2)
-		{
-			details::handleTwoRoadSegments(segmentsToTravell, startLane, endLane);
-		}
-		if (segmentsToTravell.size() >= 3)
-		{
-			details::handleMoreThanThreeRoadSegments(segmentsToTravell, startLane, endLane);
-		}
-
-		return segmentsToTravell;
+		return details::searchRoute(laneGraph, currentLane, endLane, true, false,
+			[&travelTimes](LaneId lane) { return travelTimes[lane]; });
 	}
-}
\ No newline at end of file
+}
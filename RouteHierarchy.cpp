@@ -0,0 +1,486 @@
+#include "RouteHierarchy.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace
+{
+	constexpr float unreached = std::numeric_limits<float>::max();
+
+	using QueuedLane = std::pair<float, LaneId>;
+	using LaneQueue = std::priority_queue<QueuedLane, std::vector<QueuedLane>, std::greater<QueuedLane>>;
+
+	// kept between queries so nothing is allocated or cleared whole
+	struct QueryState
+	{
+		// forward from start, backward from end
+		std::vector<float> travelTime[2];
+		std::vector<uint32_t> parentEdge[2];
+		std::vector<LaneId> touched;
+
+		void prepare(uint32_t laneCount)
+		{
+			for (uint32_t direction = 0; direction < 2; ++direction)
+			{
+				if (travelTime[direction].size() != laneCount)
+				{
+					travelTime[direction].assign(laneCount, unreached);
+					parentEdge[direction].assign(laneCount, UINT32_MAX);
+				}
+			}
+		}
+
+		void reset()
+		{
+			for (const auto& lane : touched)
+			{
+				for (uint32_t direction = 0; direction < 2; ++direction)
+				{
+					travelTime[direction][lane] = unreached;
+					parentEdge[direction][lane] = UINT32_MAX;
+				}
+			}
+			touched.clear();
+		}
+	};
+}
+
+void RouteHierarchy::build(const LaneGraph& laneGraph)
+{
+	clear();
+
+	const uint32_t laneCount = laneGraph.getLaneCount();
+	m_rank.assign(laneCount, 0);
+	m_outgoingEdges.assign(laneCount, {});
+	m_incomingEdges.assign(laneCount, {});
+	m_contracted.assign(laneCount, false);
+	m_contractedNeighbours.assign(laneCount, 0);
+	m_witnessTravelTime.assign(laneCount, unreached);
+	m_witnessTargetRound.assign(laneCount, 0);
+	m_witnessRound = 0;
+
+	createOriginalEdges(laneGraph);
+	contractLanes();
+	createUpwardRows();
+
+	// search needs only upward rows
+	m_outgoingEdges = {};
+	m_incomingEdges = {};
+	m_contracted = {};
+	m_contractedNeighbours = {};
+	m_witnessTravelTime = {};
+	m_witnessTouched = {};
+	m_witnessTargetRound = {};
+}
+
+void RouteHierarchy::clear()
+{
+	m_edges.clear();
+	m_rank.clear();
+	m_originalEdgeCount = 0;
+
+	m_forwardOffsets.clear();
+	m_forwardEdges.clear();
+	m_backwardOffsets.clear();
+	m_backwardEdges.clear();
+}
+
+bool RouteHierarchy::isBuilt() const
+{
+	return !m_forwardOffsets.empty();
+}
+
+PathFinding::TravellSegments RouteHierarchy::findRoute(const LaneGraph& laneGraph, LaneId startLane, LaneId endLane) const
+{
+	if (startLane == invalidLaneId || endLane == invalidLaneId)
+		return {};
+
+	PathFinding::TravellSegment startSegment;
+	startSegment.road = laneGraph.getRoad(startLane);
+	startSegment.lane = startLane;
+	if (startLane == endLane)
+		return { startSegment };
+
+	static thread_local QueryState state;
+	state.prepare(static_cast<uint32_t>(m_rank.size()));
+
+	LaneQueue queues[2];
+	auto reachLane = [&](uint32_t direction, LaneId lane, float travelTime, uint32_t parentEdge)
+	{
+		auto& laneTravelTime = state.travelTime[direction][lane];
+		if (travelTime >= laneTravelTime)
+			return;
+
+		if (laneTravelTime == unreached && state.travelTime[1 - direction][lane] == unreached)
+			state.touched.push_back(lane);
+
+		laneTravelTime = travelTime;
+		state.parentEdge[direction][lane] = parentEdge;
+		queues[direction].emplace(travelTime, lane);
+	};
+
+	// car may switch lanes right at start, same as in A*
+	PathFinding::details::forEachSwitchableLane(laneGraph, startLane, [&](LaneId lane)
+		{
+			const float penalty = lane != startLane ? Settings::PathFinding::laneSwitchPenalty : 0.0f;
+			reachLane(0, lane, laneGraph.getTravelTime(lane) + penalty, noEdge);
+		});
+	reachLane(1, endLane, 0.0f, noEdge);
+
+	float bestTravelTime = unreached;
+	LaneId meetingLane = invalidLaneId;
+	auto settleLane = [&](uint32_t direction)
+	{
+		const auto [travelTime, lane] = queues[direction].top();
+		queues[direction].pop();
+		// queued more times, first one was the best
+		if (travelTime > state.travelTime[direction][lane])
+			return;
+
+		const auto& offsets = direction == 0 ? m_forwardOffsets : m_backwardOffsets;
+		const auto& edges = direction == 0 ? m_forwardEdges : m_backwardEdges;
+		const auto& otherOffsets = direction == 0 ? m_backwardOffsets : m_forwardOffsets;
+		const auto& otherEdges = direction == 0 ? m_backwardEdges : m_forwardEdges;
+
+		// stall on demand, lane higher up already reached gets here faster
+		// so this one cant lie on route and is not spread from
+		for (uint32_t index = otherOffsets[lane]; index < otherOffsets[lane + 1]; ++index)
+		{
+			const auto& edge = m_edges[otherEdges[index]];
+			const LaneId higherLane = direction == 0 ? edge.from : edge.to;
+			const float higherTravelTime = state.travelTime[direction][higherLane];
+			if (higherTravelTime != unreached && higherTravelTime + edge.travelTime < travelTime)
+				return;
+		}
+
+		const float otherTravelTime = state.travelTime[1 - direction][lane];
+		if (otherTravelTime != unreached && travelTime + otherTravelTime < bestTravelTime)
+		{
+			bestTravelTime = travelTime + otherTravelTime;
+			meetingLane = lane;
+		}
+
+		for (uint32_t index = offsets[lane]; index < offsets[lane + 1]; ++index)
+		{
+			const auto& edge = m_edges[edges[index]];
+			const LaneId nextLane = direction == 0 ? edge.to : edge.from;
+			reachLane(direction, nextLane, travelTime + edge.travelTime, edges[index]);
+		}
+	};
+
+	// direction is done when nothing it has left can beat best meeting
+	auto canContinue = [&](uint32_t direction)
+	{
+		return !queues[direction].empty() && queues[direction].top().first < bestTravelTime;
+	};
+	while (canContinue(0) || canContinue(1))
+	{
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			if (canContinue(direction))
+				settleLane(direction);
+		}
+	}
+
+	PathFinding::TravellSegments travellSegments;
+	if (meetingLane != invalidLaneId)
+	{
+		std::vector<uint32_t> routeEdges;
+		LaneId firstLane = meetingLane;
+		for (; state.parentEdge[0][firstLane] != noEdge; firstLane = m_edges[state.parentEdge[0][firstLane]].from)
+			routeEdges.push_back(state.parentEdge[0][firstLane]);
+		std::reverse(std::begin(routeEdges), std::end(routeEdges));
+		for (LaneId lane = meetingLane; state.parentEdge[1][lane] != noEdge; lane = m_edges[state.parentEdge[1][lane]].to)
+			routeEdges.push_back(state.parentEdge[1][lane]);
+
+		if (firstLane != startLane)
+			startSegment.switchLane = firstLane;
+		travellSegments.push_back(startSegment);
+		for (const auto& edge : routeEdges)
+			unpackEdge(edge, travellSegments, laneGraph);
+	}
+
+	state.reset();
+
+	return travellSegments;
+}
+
+uint32_t RouteHierarchy::getShortcutCount() const
+{
+	return static_cast<uint32_t>(m_edges.size()) - m_originalEdgeCount;
+}
+
+size_t RouteHierarchy::getMemoryUsage() const
+{
+	return m_edges.capacity() * sizeof(Edge) +
+		(m_rank.capacity() + m_forwardOffsets.capacity() + m_forwardEdges.capacity() +
+			m_backwardOffsets.capacity() + m_backwardEdges.capacity()) * sizeof(uint32_t);
+}
+
+void RouteHierarchy::createOriginalEdges(const LaneGraph& laneGraph)
+{
+	for (LaneId lane = 0; lane < laneGraph.getLaneCount(); ++lane)
+	{
+		for (const auto& nextLane : laneGraph.getSuccessors(lane))
+		{
+			// same edges as A* walks
+			PathFinding::details::forEachSwitchableLane(laneGraph, nextLane, [&](LaneId drivenLane)
+				{
+					if (drivenLane == lane)
+						return;
+
+					const float penalty = drivenLane != nextLane ? Settings::PathFinding::laneSwitchPenalty : 0.0f;
+
+					Edge edge;
+					edge.from = lane;
+					edge.to = drivenLane;
+					edge.travelTime = laneGraph.getTravelTime(drivenLane) + penalty;
+					edge.enteredLane = nextLane;
+
+					// only the fastest way between two lanes matters
+					for (const auto& edgeIndex : m_outgoingEdges[lane])
+					{
+						auto& existingEdge = m_edges[edgeIndex];
+						if (existingEdge.to == drivenLane)
+						{
+							if (edge.travelTime < existingEdge.travelTime)
+								existingEdge = edge;
+							return;
+						}
+					}
+					addEdge(edge);
+				});
+		}
+	}
+
+	m_originalEdgeCount = static_cast<uint32_t>(m_edges.size());
+}
+
+void RouteHierarchy::contractLanes()
+{
+	std::priority_queue<std::pair<int32_t, LaneId>, std::vector<std::pair<int32_t, LaneId>>, std::greater<>> lanesToContract;
+	for (LaneId lane = 0; lane < m_rank.size(); ++lane)
+		lanesToContract.emplace(getPriority(lane), lane);
+
+	uint32_t rank = 0;
+	while (!lanesToContract.empty())
+	{
+		const LaneId lane = lanesToContract.top().second;
+		lanesToContract.pop();
+
+		// priorities of others went stale as neighbours got contracted, so check again
+		const int32_t priority = getPriority(lane);
+		if (!lanesToContract.empty() && priority > lanesToContract.top().first)
+		{
+			lanesToContract.emplace(priority, lane);
+			continue;
+		}
+
+		contractLane(lane, true);
+		m_contracted[lane] = true;
+		m_rank[lane] = rank++;
+
+		for (const auto& edge : m_outgoingEdges[lane])
+			++m_contractedNeighbours[m_edges[edge].to];
+		for (const auto& edge : m_incomingEdges[lane])
+			++m_contractedNeighbours[m_edges[edge].from];
+	}
+}
+
+RouteHierarchy::Contraction RouteHierarchy::contractLane(LaneId lane, bool addShortcuts)
+{
+	Contraction contraction;
+	// shortcuts are not added to lists of contracted lane, so indexing is safe
+	for (uint32_t incomingIndex = 0; incomingIndex < m_incomingEdges[lane].size(); ++incomingIndex)
+	{
+		const uint32_t incomingEdge = m_incomingEdges[lane][incomingIndex];
+		const auto incoming = m_edges[incomingEdge];
+		if (m_contracted[incoming.from])
+			continue;
+
+		float maxTravelTime = 0.0f;
+		uint32_t targetCount = 0;
+		++m_witnessRound;
+		for (const auto& outgoingEdge : m_outgoingEdges[lane])
+		{
+			const auto& outgoing = m_edges[outgoingEdge];
+			if (m_contracted[outgoing.to] || outgoing.to == incoming.from)
+				continue;
+
+			maxTravelTime = std::max(maxTravelTime, incoming.travelTime + outgoing.travelTime);
+			if (m_witnessTargetRound[outgoing.to] != m_witnessRound)
+			{
+				m_witnessTargetRound[outgoing.to] = m_witnessRound;
+				++targetCount;
+			}
+		}
+		if (targetCount == 0)
+			continue;
+
+		searchWitnesses(incoming.from, lane, maxTravelTime, targetCount);
+
+		for (uint32_t outgoingIndex = 0; outgoingIndex < m_outgoingEdges[lane].size(); ++outgoingIndex)
+		{
+			const uint32_t outgoingEdge = m_outgoingEdges[lane][outgoingIndex];
+			const auto outgoing = m_edges[outgoingEdge];
+			if (m_contracted[outgoing.to] || outgoing.to == incoming.from)
+				continue;
+
+			// other way is as fast, no shortcut needed
+			const float travelTime = incoming.travelTime + outgoing.travelTime;
+			if (m_witnessTravelTime[outgoing.to] <= travelTime)
+				continue;
+
+			++contraction.shortcutCount;
+			contraction.shortcutHops += incoming.hops + outgoing.hops;
+			if (addShortcuts)
+			{
+				Edge shortcut;
+				shortcut.from = incoming.from;
+				shortcut.to = outgoing.to;
+				shortcut.travelTime = travelTime;
+				shortcut.firstEdge = incomingEdge;
+				shortcut.secondEdge = outgoingEdge;
+				shortcut.hops = incoming.hops + outgoing.hops;
+				addEdge(shortcut);
+			}
+		}
+	}
+
+	return contraction;
+}
+
+void RouteHierarchy::searchWitnesses(LaneId from, LaneId skippedLane, float maxTravelTime, uint32_t targetCount)
+{
+	for (const auto& lane : m_witnessTouched)
+		m_witnessTravelTime[lane] = unreached;
+	m_witnessTouched.clear();
+
+	LaneQueue openLanes;
+	m_witnessTravelTime[from] = 0.0f;
+	m_witnessTouched.push_back(from);
+	openLanes.emplace(0.0f, from);
+
+	uint32_t settledCount = 0;
+	while (!openLanes.empty() && settledCount < Settings::RouteHierarchy::witnessSettleLimit)
+	{
+		const auto [travelTime, lane] = openLanes.top();
+		openLanes.pop();
+		if (travelTime > m_witnessTravelTime[lane])
+			continue;
+		if (travelTime > maxTravelTime)
+			break;
+		++settledCount;
+
+		// targets settled, rest cant get any better
+		if (m_witnessTargetRound[lane] == m_witnessRound && --targetCount == 0)
+			break;
+
+		for (const auto& edgeIndex : m_outgoingEdges[lane])
+		{
+			const auto& edge = m_edges[edgeIndex];
+			if (m_contracted[edge.to] || edge.to == skippedLane)
+				continue;
+
+			const float nextTravelTime = travelTime + edge.travelTime;
+			if (nextTravelTime < m_witnessTravelTime[edge.to])
+			{
+				if (m_witnessTravelTime[edge.to] == unreached)
+					m_witnessTouched.push_back(edge.to);
+
+				m_witnessTravelTime[edge.to] = nextTravelTime;
+				openLanes.emplace(nextTravelTime, edge.to);
+			}
+		}
+	}
+}
+
+int32_t RouteHierarchy::getPriority(LaneId lane)
+{
+	Contraction removed;
+	auto countRemoved = [&](const std::vector<uint32_t>& edges, bool outgoing)
+	{
+		for (const auto& edgeIndex : edges)
+		{
+			const auto& edge = m_edges[edgeIndex];
+			if (m_contracted[outgoing ? edge.to : edge.from])
+				continue;
+
+			++removed.shortcutCount;
+			removed.shortcutHops += edge.hops;
+		}
+	};
+	countRemoved(m_outgoingEdges[lane], true);
+	countRemoved(m_incomingEdges[lane], false);
+
+	// lanes which add fewer and shorter shortcuts than edges they remove go first,
+	// contracted neighbours spread contraction over whole network
+	const auto added = contractLane(lane, false);
+
+	return (added.shortcutCount - removed.shortcutCount) + (added.shortcutHops - removed.shortcutHops) +
+		static_cast<int32_t>(m_contractedNeighbours[lane]);
+}
+
+void RouteHierarchy::addEdge(Edge edge)
+{
+	const uint32_t edgeIndex = static_cast<uint32_t>(m_edges.size());
+	m_outgoingEdges[edge.from].push_back(edgeIndex);
+	m_incomingEdges[edge.to].push_back(edgeIndex);
+	m_edges.push_back(edge);
+}
+
+void RouteHierarchy::createUpwardRows()
+{
+	const uint32_t laneCount = static_cast<uint32_t>(m_rank.size());
+	m_forwardOffsets.assign(laneCount + 1, 0);
+	m_backwardOffsets.assign(laneCount + 1, 0);
+
+	// every edge is searched from its lower lane
+	auto goesUp = [this](const Edge& edge) { return m_rank[edge.from] < m_rank[edge.to]; };
+	for (const auto& edge : m_edges)
+	{
+		if (goesUp(edge))
+			++m_forwardOffsets[edge.from + 1];
+		else
+			++m_backwardOffsets[edge.to + 1];
+	}
+	for (LaneId lane = 0; lane < laneCount; ++lane)
+	{
+		m_forwardOffsets[lane + 1] += m_forwardOffsets[lane];
+		m_backwardOffsets[lane + 1] += m_backwardOffsets[lane];
+	}
+
+	m_forwardEdges.resize(m_forwardOffsets.back());
+	m_backwardEdges.resize(m_backwardOffsets.back());
+	auto forwardPositions = m_forwardOffsets;
+	auto backwardPositions = m_backwardOffsets;
+	for (uint32_t edgeIndex = 0; edgeIndex < m_edges.size(); ++edgeIndex)
+	{
+		const auto& edge = m_edges[edgeIndex];
+		if (goesUp(edge))
+			m_forwardEdges[forwardPositions[edge.from]++] = edgeIndex;
+		else
+			m_backwardEdges[backwardPositions[edge.to]++] = edgeIndex;
+	}
+}
+
+void RouteHierarchy::unpackEdge(uint32_t edgeIndex, PathFinding::TravellSegments& travellSegments, const LaneGraph& laneGraph) const
+{
+	const auto& edge = m_edges[edgeIndex];
+	if (edge.firstEdge != noEdge)
+	{
+		unpackEdge(edge.firstEdge, travellSegments, laneGraph);
+		unpackEdge(edge.secondEdge, travellSegments, laneGraph);
+		return;
+	}
+
+	PathFinding::TravellSegment segment;
+	segment.road = laneGraph.getRoad(edge.to);
+	segment.lane = edge.enteredLane;
+	if (edge.enteredLane != edge.to)
+		segment.switchLane = edge.to;
+
+	travellSegments.push_back(segment);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "LaneGraph.h"
+#include "RoadPathFinder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Settings
+{
+	namespace RouteHierarchy
+	{
+		// built when simulation starts, otherwise routes go through A*
+		constexpr bool enabled = true;
+		// smaller networks are routed fast enough without it
+		constexpr uint32_t minLaneCount = 2'000;
+		// witness search gives up after this many lanes and adds shortcut anyway,
+		// low limits add so many shortcuts that both build and query get slower
+		constexpr uint32_t witnessSettleLimit = 1'000;
+	}
+}
+
+/*
+*	Contraction hierarchy over lanes. Lanes are contracted one by one
+*	from least important, shortcuts keep travel times between lanes left.
+*	Query then searches only upwards from both ends and meets in middle,
+*	so it touches just a few lanes even on big networks.
+*	Weights are frozen when built, same as A* ones in PathFinding.
+*/
+class RouteHierarchy
+{
+public:
+	void build(const LaneGraph& laneGraph);
+	void clear();
+	bool isBuilt() const;
+
+	// same route as PathFinding::findRoute, empty when end cant be reached
+	PathFinding::TravellSegments findRoute(const LaneGraph& laneGraph, LaneId startLane, LaneId endLane) const;
+
+	uint32_t getShortcutCount() const;
+	size_t getMemoryUsage() const;
+private:
+	static constexpr uint32_t noEdge = UINT32_MAX;
+
+	// original edge leads into lane car drives, shortcut replaces two edges
+	struct Edge
+	{
+		LaneId from = invalidLaneId;
+		LaneId to = invalidLaneId;
+		float travelTime = 0.0f;
+		// original edges, lane car entered before switching to lane edge leads to
+		LaneId enteredLane = invalidLaneId;
+		// shortcuts
+		uint32_t firstEdge = noEdge;
+		uint32_t secondEdge = noEdge;
+		// original edges it stands for
+		uint32_t hops = 1;
+	};
+	struct Contraction
+	{
+		int32_t shortcutCount = 0;
+		int32_t shortcutHops = 0;
+	};
+
+	void createOriginalEdges(const LaneGraph& laneGraph);
+	void contractLanes();
+	// shortcuts are added only when asked
+	Contraction contractLane(LaneId lane, bool addShortcuts);
+	// travel times from lane without going through skipped one, up to max,
+	// stops once lanes marked with current round are all settled
+	void searchWitnesses(LaneId from, LaneId skippedLane, float maxTravelTime, uint32_t targetCount);
+	int32_t getPriority(LaneId lane);
+	void addEdge(Edge edge);
+	void createUpwardRows();
+	void unpackEdge(uint32_t edge, PathFinding::TravellSegments& travellSegments, const LaneGraph& laneGraph) const;
+
+	std::vector<Edge> m_edges;
+	std::vector<uint32_t> m_rank;
+	uint32_t m_originalEdgeCount = 0;
+
+	// compressed rows of edge ids, forward ones go up from lane,
+	// backward ones come to lane from above
+	std::vector<uint32_t> m_forwardOffsets;
+	std::vector<uint32_t> m_forwardEdges;
+	std::vector<uint32_t> m_backwardOffsets;
+	std::vector<uint32_t> m_backwardEdges;
+
+	// only while building
+	std::vector<std::vector<uint32_t>> m_outgoingEdges;
+	std::vector<std::vector<uint32_t>> m_incomingEdges;
+	std::vector<bool> m_contracted;
+	std::vector<uint32_t> m_contractedNeighbours;
+	std::vector<float> m_witnessTravelTime;
+	std::vector<LaneId> m_witnessTouched;
+	std::vector<uint32_t> m_witnessTargetRound;
+	uint32_t m_witnessRound = 0;
+};
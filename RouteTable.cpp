@@ -0,0 +1,185 @@
+#include "RouteTable.h"
+#include "RouteHierarchy.h"
+#include "CarSpawner.h"
+#include "GlobalObjects.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace
+{
+	LaneId randomLane(const LaneGraph& laneGraph, const BasicRoad* road, Lane::Side side, std::mt19937& engine)
+	{
+		std::vector<LaneId> lanes;
+		const auto roadLanes = laneGraph.getRoadLanes(road);
+		for (LaneId lane = roadLanes.first; lane < roadLanes.last; ++lane)
+		{
+			if (laneGraph.getSide(lane) == side)
+				lanes.push_back(lane);
+		}
+		if (lanes.empty())
+			return invalidLaneId;
+
+		std::uniform_int_distribution<size_t> randomDistributor(0, lanes.size() - 1);
+
+		return lanes[randomDistributor(engine)];
+	}
+
+	// moves lanes to ids they got in new lane graph
+	void moveRoute(PathFinding::TravellSegments& route, const LaneGraph& laneGraph,
+		const std::unordered_map<const BasicRoad*, LaneId>& previousFirstLanes)
+	{
+		auto moveLane = [](LaneId& lane, LaneId previousFirstLane, LaneId firstLane)
+		{
+			if (lane != invalidLaneId)
+				lane = firstLane + (lane - previousFirstLane);
+		};
+
+		for (auto& segment : route)
+		{
+			const LaneId previousFirstLane = previousFirstLanes.at(segment.road);
+			const LaneId firstLane = laneGraph.getRoadLanes(segment.road).first;
+
+			moveLane(segment.lane, previousFirstLane, firstLane);
+			moveLane(segment.switchLane, previousFirstLane, firstLane);
+		}
+	}
+}
+
+void RouteTable::build(const std::vector<CarSpawner>& spawners, const LaneGraph& laneGraph, const RouteHierarchy& routeHierarchy,
+	const std::unordered_set<const BasicRoad*>& unchangedRoads)
+{
+	// last table to take unchanged routes from
+	const auto previousIndices = std::move(m_spawnerIndices);
+	auto previousRoutes = std::move(m_routes);
+	const uint32_t previousCount = m_spawnerCount;
+	const auto previousFirstLanes = std::move(m_firstLanes);
+	clear();
+
+	m_spawnerCount = static_cast<uint32_t>(spawners.size());
+	for (uint32_t index = 0; index < m_spawnerCount; ++index)
+		m_spawnerIndices[&spawners[index]] = index;
+	m_routes.resize(m_spawnerCount * m_spawnerCount);
+
+	auto isUnchanged = [&unchangedRoads](const PathFinding::TravellSegments& route)
+	{
+		return !route.empty() && std::all_of(std::begin(route), std::end(route), [&unchangedRoads](const auto& segment)
+			{
+				return unchangedRoads.count(segment.road) != 0;
+			});
+	};
+
+	std::vector<uint32_t> searchedPairs;
+	for (uint32_t pair = 0; pair < m_routes.size(); ++pair)
+	{
+		const uint32_t origin = pair / m_spawnerCount;
+		const uint32_t destination = pair % m_spawnerCount;
+		// dont make with self
+		if (origin == destination)
+			continue;
+
+		// route starts and ends on spawners, so unchanged route means same spawners too
+		auto previousOrigin = previousIndices.find(&spawners[origin]);
+		auto previousDestination = previousIndices.find(&spawners[destination]);
+		if (previousOrigin != previousIndices.end() && previousDestination != previousIndices.end())
+		{
+			auto& previousRoute = previousRoutes[previousOrigin->second * previousCount + previousDestination->second];
+			if (isUnchanged(previousRoute))
+			{
+				moveRoute(previousRoute, laneGraph, previousFirstLanes);
+				m_routes[pair] = std::move(previousRoute);
+				continue;
+			}
+		}
+
+		searchedPairs.push_back(pair);
+	}
+
+	// every pair has own engine, so jobs dont share one
+	const auto seed = static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	App::jobSystem.parallelFor(static_cast<uint32_t>(searchedPairs.size()), [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t index = begin; index < end; ++index)
+			{
+				const uint32_t pair = searchedPairs[index];
+				const uint32_t origin = pair / m_spawnerCount;
+				const uint32_t destination = pair % m_spawnerCount;
+
+				std::mt19937 engine(seed + pair);
+				const LaneId startLane = randomLane(laneGraph, &spawners[origin], Lane::Side::RIGHT, engine);
+				// left since we enter from opposite direction
+				const LaneId endLane = randomLane(laneGraph, &spawners[destination], Lane::Side::LEFT, engine);
+
+				m_routes[pair] = findRoute(laneGraph, routeHierarchy, startLane, endLane);
+			}
+		}, Settings::RouteTable::grainSize);
+
+	for (const auto& route : m_routes)
+	{
+		for (const auto& segment : route)
+			m_firstLanes[segment.road] = laneGraph.getRoadLanes(segment.road).first;
+	}
+}
+
+void RouteTable::clear()
+{
+	m_spawnerIndices.clear();
+	m_routes.clear();
+	m_spawnerCount = 0;
+	m_firstLanes.clear();
+}
+
+const PathFinding::TravellSegments* RouteTable::getRoute(const CarSpawner* origin, const CarSpawner* destination) const
+{
+	const uint32_t originIndex = getSpawnerIndex(origin);
+	const uint32_t destinationIndex = getSpawnerIndex(destination);
+	if (originIndex == UINT32_MAX || destinationIndex == UINT32_MAX)
+		return nullptr;
+
+	const auto& route = m_routes[originIndex * m_spawnerCount + destinationIndex];
+
+	return route.empty() ? nullptr : &route;
+}
+
+const PathFinding::TravellSegments* RouteTable::getRandomRoute(const CarSpawner* origin, std::mt19937& engine) const
+{
+	const uint32_t originIndex = getSpawnerIndex(origin);
+	if (originIndex == UINT32_MAX)
+		return nullptr;
+
+	const auto routesBegin = std::begin(m_routes) + originIndex * m_spawnerCount;
+	const auto routesEnd = routesBegin + m_spawnerCount;
+	auto isReachable = [](const PathFinding::TravellSegments& route) { return !route.empty(); };
+
+	const auto reachableCount = std::count_if(routesBegin, routesEnd, isReachable);
+	if (reachableCount == 0)
+		return nullptr;
+
+	// counted down to chosen one, row is walked without allocating
+	std::uniform_int_distribution<ptrdiff_t> randomDistributor(0, reachableCount - 1);
+	auto chosen = randomDistributor(engine);
+	for (auto route = routesBegin; route != routesEnd; ++route)
+	{
+		if (isReachable(*route) && chosen-- == 0)
+			return &*route;
+	}
+
+	return nullptr;
+}
+
+PathFinding::TravellSegments RouteTable::findRoute(const LaneGraph& laneGraph, const RouteHierarchy& routeHierarchy,
+	LaneId startLane, LaneId endLane)
+{
+	if (routeHierarchy.isBuilt())
+		return routeHierarchy.findRoute(laneGraph, startLane, endLane);
+
+	return PathFinding::findRoute(laneGraph, startLane, endLane);
+}
+
+uint32_t RouteTable::getSpawnerIndex(const CarSpawner* spawner) const
+{
+	auto spawnerIndex = m_spawnerIndices.find(spawner);
+
+	return spawnerIndex != m_spawnerIndices.end() ? spawnerIndex->second : UINT32_MAX;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "LaneGraph.h"
+#include "RoadPathFinder.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class CarSpawner;
+class RouteHierarchy;
+
+namespace Settings
+{
+	namespace RouteTable
+	{
+		// route searches given to one job
+		constexpr uint32_t grainSize = 4;
+	}
+}
+
+/*
+*	Route from every spawner to every other, searched in parallel
+*	when simulation starts. Searches only read lane graph, every
+*	one writes its own cell, so no locking is needed.
+*	Routes going only through unchanged roads are kept from last build,
+*	they stay drivable but dont notice faster roads added elsewhere.
+*/
+class RouteTable
+{
+public:
+	void build(const std::vector<CarSpawner>& spawners, const LaneGraph& laneGraph, const RouteHierarchy& routeHierarchy,
+		const std::unordered_set<const BasicRoad*>& unchangedRoads = {});
+	void clear();
+
+	// nullptr when spawners are not connected
+	const PathFinding::TravellSegments* getRoute(const CarSpawner* origin, const CarSpawner* destination) const;
+	// to random destination reachable from origin
+	const PathFinding::TravellSegments* getRandomRoute(const CarSpawner* origin, std::mt19937& engine) const;
+
+	// hierarchy when built, A* otherwise
+	static PathFinding::TravellSegments findRoute(const LaneGraph& laneGraph, const RouteHierarchy& routeHierarchy,
+		LaneId startLane, LaneId endLane);
+private:
+	uint32_t getSpawnerIndex(const CarSpawner* spawner) const;
+
+	std::unordered_map<const CarSpawner*, uint32_t> m_spawnerIndices;
+	// origin rows, destination columns
+	std::vector<PathFinding::TravellSegments> m_routes;
+	uint32_t m_spawnerCount = 0;
+	// first lane id of roads on routes when they were built
+	std::unordered_map<const BasicRoad*, LaneId> m_firstLanes;
+};
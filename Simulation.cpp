@@ -1,20 +1,25 @@
 #include "Simulation.h"
+#include "GlobalObjects.h"
 
 void Simulation::updateSimulation()
 {
+	// remaining objects like spawners change shared state, so they go one by one
 	for (auto& object : m_simulationAreaObjects)
 	{
-		if(object->isActive())
+		if (object->isActive())
 			object->update();
 	}
+
+	// cars sense and act in parallel phases inside engine
+	App::vehicleEngine.update();
 }
 
-void Simulation::registerObject(pSimulationObject toRegister)
+SlotHandle Simulation::registerObject(pSimulationObject toRegister)
 {
-	m_simulationAreaObjects.emplace_back(toRegister);
+	return m_simulationAreaObjects.insert(toRegister);
 }
 
-void Simulation::unregisterObject(pSimulationObject toUnregister)
+void Simulation::unregisterObject(SlotHandle handle)
 {
-	m_simulationAreaObjects.erase(std::find(std::begin(m_simulationAreaObjects), std::end(m_simulationAreaObjects), toUnregister));
+	m_simulationAreaObjects.remove(handle);
 }
@@ -1,14 +1,14 @@
 #pragma once
 #include "SimulationObject.h"
-#include <list>
+#include "SlotMap.h"
 class Simulation
 {
 public:
 	void updateSimulation();
 
-	void registerObject(pSimulationObject toRegister);
-	void unregisterObject(pSimulationObject toUnregister);
+	SlotHandle registerObject(pSimulationObject toRegister);
+	void unregisterObject(SlotHandle handle);
 private:
-	std::list<pSimulationObject> m_simulationAreaObjects;
+	SlotMap<pSimulationObject> m_simulationAreaObjects;
 };
 
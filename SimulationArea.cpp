@@ -1,7 +1,7 @@
 #include "SimulationArea.h"
 #include "GlobalObjects.h"
-#include "SimpleCar.h"
 #include <optional>
+#include <unordered_set>
 #include "RoadPathFinder.h"
 
 static std::optional<glm::vec3> planeIntersectPoint(const glm::vec3& rayDirection, const glm::vec3& rayPosition,
@@ -531,34 +531,69 @@ void SimulationArea::runSimulation()
 {
 	// reset and setup
 	{
-		// first setup roads then inrersections since intersection rely on 
-		// road paths being setup and spawners as well
-		for (auto& road : m_objectManager.m_roads.data)
+		// intersections and spawners copy lanes of roads they connect to
+		for (const auto& road : m_objectManager.m_roads.data)
 		{
-			road.createLanes();
-			//road.resetNearbyBuildings();
+			if (!road.areLanesDirty())
+				continue;
+
+			for (const auto& connection : road.getConnections())
+				connection.connected->markLanesDirty();
 		}
 
-		//static PathVisualizer visualizer;
-		for (auto& intersection : m_objectManager.m_intersections.data)
+		std::vector<const BasicRoad*> roads;
+		// routes going only through these are kept
+		std::unordered_set<const BasicRoad*> unchangedRoads;
+		bool lanesChanged = false;
+		auto addRoads = [&](const auto& objects)
 		{
-			intersection.createLanes();
-		}
-		//visualizer.setupDraws();
-		for (auto& spawner : m_objectManager.m_carSpawners.data)
+			for (const auto& object : objects)
+			{
+				roads.push_back(&object);
+				if (object.areLanesDirty())
+					lanesChanged = true;
+				else
+					unchangedRoads.insert(&object);
+			}
+		};
+		addRoads(m_objectManager.m_roads.data);
+		addRoads(m_objectManager.m_intersections.data);
+		addRoads(m_objectManager.m_carSpawners.data);
+
+		// first setup roads then inrersections since intersection rely on 
+		// road paths being setup and spawners as well,
+		// inside one group objects only read others so they go in parallel,
+		// only marked ones are recreated
+		auto updateLanes = [](auto& objects)
 		{
-			spawner.createLanes();
-		}
-	}
+			App::jobSystem.parallelFor(static_cast<uint32_t>(objects.size()), [&objects](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t index = begin; index < end; ++index)
+						objects[index].updateLanes();
+				}, 8);
+		};
+		updateLanes(m_objectManager.m_roads.data);
 
-	// init spawners
-	{
-		for(auto & spawner : m_objectManager.m_carSpawners.data)
+		//static PathVisualizer visualizer;
+		updateLanes(m_objectManager.m_intersections.data);
+		//visualizer.setupDraws();
+		updateLanes(m_objectManager.m_carSpawners.data);
+
+		// lanes dont change while running, compile them once,
+		// same network from last run is kept as it is
+		if (lanesChanged || !App::laneGraph.isBuiltFrom(roads))
 		{
-			spawner.initializePossiblePaths(m_objectManager.m_carSpawners.data);
+			App::laneGraph.build(roads);
+			App::routeHierarchy.clear();
+			if (Settings::RouteHierarchy::enabled && App::laneGraph.getLaneCount() >= Settings::RouteHierarchy::minLaneCount)
+				App::routeHierarchy.build(App::laneGraph);
 		}
+
+		// init spawners
+		App::routeTable.build(m_objectManager.m_carSpawners.data, App::laneGraph, App::routeHierarchy, unchangedRoads);
 	}
 	{
+		App::vehicleEngine.clear();
 		for (auto& spawner : m_objectManager.m_carSpawners.data)
 		{
 			spawner.enable();
@@ -614,6 +649,8 @@ void SimulationArea::stopSimulation()
 	{
 		spawner.disable();
 	}
+	// lanes, graph and routes stay for next run, edits mark what has to be redone
+	App::vehicleEngine.clear();
 }
 
 TopMenu::TopMenu(SimulationArea* pSimulationArea)
@@ -7,7 +7,6 @@
 #include <glm/glm.hpp>
 #include "GraphicsComponent.h"
 #include "SimulationObject.h"
-#include "SimpleCar.h"
 #include "ObjectManager.h"
 #include "RoadInspector.h"
 
@@ -7,18 +7,18 @@
 
 SimulationObject::SimulationObject()
 {
-	App::simulation.registerObject(this);
+	m_simulationHandle = App::simulation.registerObject(this);
 	m_components.physics.setOwner(this);
 }
 
 SimulationObject::~SimulationObject()
 {
-	App::simulation.unregisterObject(this);
+	App::simulation.unregisterObject(m_simulationHandle);
 }
 
 SimulationObject::SimulationObject(const SimulationObject& copy)
 {
-	App::simulation.registerObject(this);
+	m_simulationHandle = App::simulation.registerObject(this);
 
 	m_components.graphics = copy.m_components.graphics;
 	m_components.physics = copy.m_components.physics;
@@ -34,7 +34,7 @@ SimulationObject::SimulationObject(const SimulationObject& copy)
 
 SimulationObject::SimulationObject(SimulationObject&& move)
 {
-	App::simulation.registerObject(this);
+	m_simulationHandle = App::simulation.registerObject(this);
 
 	m_components.graphics.operator=(std::move(move.m_components.graphics));
 	m_components.physics.operator=(std::move(move.m_components.physics));
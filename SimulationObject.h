@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include "GraphicsComponent.h"
 #include "PhysicsComponent.h"
+#include "SlotMap.h"
 
 class SimulationObject
 {
@@ -50,6 +51,9 @@ private:
 		PhysicsComponent physics;
 	} m_components;
 
+	// own registration, never copied nor moved
+	SlotHandle m_simulationHandle;
+
 	glm::vec3 m_position;
 	glm::vec3 m_rotation;
 
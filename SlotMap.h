@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+*	Handle stays valid until its value is removed,
+*	removed slot gets new generation so old handles miss
+*/
+struct SlotHandle
+{
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool valid() const { return index != UINT32_MAX; }
+};
+
+/*
+*	Values are kept dense for iteration, removal swaps
+*	last value in place so order is not kept
+*/
+template<class Type> class SlotMap
+{
+public:
+	SlotHandle insert(Type value);
+	// false if handle was already removed
+	bool remove(SlotHandle handle);
+	// nullptr if handle was already removed
+	Type* get(SlotHandle handle);
+	const Type* get(SlotHandle handle) const;
+	bool contains(SlotHandle handle) const;
+
+	std::size_t size() const { return m_values.size(); }
+	bool empty() const { return m_values.empty(); }
+	void clear();
+
+	typename std::vector<Type>::iterator begin() { return m_values.begin(); }
+	typename std::vector<Type>::iterator end() { return m_values.end(); }
+	typename std::vector<Type>::const_iterator begin() const { return m_values.begin(); }
+	typename std::vector<Type>::const_iterator end() const { return m_values.end(); }
+private:
+	struct Slot
+	{
+		uint32_t valueIndex;
+		uint32_t generation;
+	};
+
+	std::vector<Type> m_values;
+	// slot of every value, to fix slot when value is moved
+	std::vector<uint32_t> m_valueSlots;
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+};
+
+template<class Type>
+SlotHandle SlotMap<Type>::insert(Type value)
+{
+	uint32_t slotIndex;
+	if (m_freeSlots.empty())
+	{
+		slotIndex = static_cast<uint32_t>(m_slots.size());
+		m_slots.push_back(Slot{ 0, 0 });
+	}
+	else
+	{
+		slotIndex = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	auto& slot = m_slots[slotIndex];
+	slot.valueIndex = static_cast<uint32_t>(m_values.size());
+	m_values.emplace_back(std::move(value));
+	m_valueSlots.push_back(slotIndex);
+
+	return SlotHandle{ slotIndex, slot.generation };
+}
+
+template<class Type>
+bool SlotMap<Type>::remove(SlotHandle handle)
+{
+	if (!contains(handle))
+		return false;
+
+	auto& slot = m_slots[handle.index];
+	const uint32_t lastIndex = static_cast<uint32_t>(m_values.size() - 1);
+
+	// fill the hole with last one
+	if (slot.valueIndex != lastIndex)
+	{
+		m_values[slot.valueIndex] = std::move(m_values[lastIndex]);
+		m_valueSlots[slot.valueIndex] = m_valueSlots[lastIndex];
+		m_slots[m_valueSlots[slot.valueIndex]].valueIndex = slot.valueIndex;
+	}
+	m_values.pop_back();
+	m_valueSlots.pop_back();
+
+	++slot.generation;
+	m_freeSlots.push_back(handle.index);
+
+	return true;
+}
+
+template<class Type>
+Type* SlotMap<Type>::get(SlotHandle handle)
+{
+	if (!contains(handle))
+		return nullptr;
+
+	return &m_values[m_slots[handle.index].valueIndex];
+}
+
+template<class Type>
+const Type* SlotMap<Type>::get(SlotHandle handle) const
+{
+	if (!contains(handle))
+		return nullptr;
+
+	return &m_values[m_slots[handle.index].valueIndex];
+}
+
+template<class Type>
+bool SlotMap<Type>::contains(SlotHandle handle) const
+{
+	return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+}
+
+template<class Type>
+void SlotMap<Type>::clear()
+{
+	// bump generations so no handle survives
+	m_freeSlots.clear();
+	for (uint32_t slotIndex = 0; slotIndex < m_slots.size(); ++slotIndex)
+	{
+		++m_slots[slotIndex].generation;
+		m_freeSlots.push_back(slotIndex);
+	}
+
+	m_values.clear();
+	m_valueSlots.clear();
+}
@@ -0,0 +1,236 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+void SweepAndPrune::clear()
+{
+	m_endpoints[0].clear();
+	m_endpoints[1].clear();
+	m_boxes.clear();
+	m_alive.clear();
+	m_overlaps.clear();
+	m_pairCount = 0;
+
+	m_insertedProxies.clear();
+	m_removedProxies.clear();
+	m_freeProxies.clear();
+}
+
+uint32_t SweepAndPrune::insert(const glm::vec2& min, const glm::vec2& max)
+{
+	uint32_t proxy;
+	if (m_freeProxies.empty())
+	{
+		proxy = static_cast<uint32_t>(m_boxes.size());
+		m_boxes.emplace_back();
+		m_alive.push_back(false);
+		m_overlaps.emplace_back();
+	}
+	else
+	{
+		proxy = m_freeProxies.back();
+		m_freeProxies.pop_back();
+	}
+
+	m_boxes[proxy] = { min, max };
+	m_alive[proxy] = true;
+	m_insertedProxies.push_back(proxy);
+
+	return proxy;
+}
+
+void SweepAndPrune::update(uint32_t proxy, const glm::vec2& min, const glm::vec2& max)
+{
+	m_boxes[proxy] = { min, max };
+}
+
+void SweepAndPrune::remove(uint32_t proxy)
+{
+	auto& overlaps = m_overlaps[proxy];
+	for (const auto& other : overlaps)
+	{
+		auto& otherOverlaps = m_overlaps[other];
+		*std::find(std::begin(otherOverlaps), std::end(otherOverlaps), proxy) = otherOverlaps.back();
+		otherOverlaps.pop_back();
+	}
+	m_pairCount -= static_cast<uint32_t>(overlaps.size());
+	overlaps.clear();
+
+	m_alive[proxy] = false;
+	m_removedProxies.push_back(proxy);
+}
+
+void SweepAndPrune::commit()
+{
+	const size_t oldProxyCount = m_endpoints[0].size() / 2;
+	const bool manyInserted = m_insertedProxies.size() > oldProxyCount;
+
+	for (uint32_t axis = 0; axis < 2; ++axis)
+		refreshEndpoints(axis);
+
+	if (manyInserted)
+	{
+		rebuild();
+	}
+	else
+	{
+		for (uint32_t axis = 0; axis < 2; ++axis)
+			sortEndpoints(axis);
+	}
+
+	m_insertedProxies.clear();
+	m_freeProxies.insert(std::end(m_freeProxies), std::begin(m_removedProxies), std::end(m_removedProxies));
+	m_removedProxies.clear();
+}
+
+const std::vector<uint32_t>& SweepAndPrune::getOverlaps(uint32_t proxy) const
+{
+	return m_overlaps[proxy];
+}
+
+uint32_t SweepAndPrune::getPairCount() const
+{
+	return m_pairCount;
+}
+
+uint32_t SweepAndPrune::getProxy(const Endpoint& endpoint)
+{
+	return endpoint.data >> 1;
+}
+
+bool SweepAndPrune::isMax(const Endpoint& endpoint)
+{
+	return endpoint.data & 1;
+}
+
+bool SweepAndPrune::isBefore(const Endpoint& first, const Endpoint& second)
+{
+	return first.value < second.value || (first.value == second.value && !isMax(first) && isMax(second));
+}
+
+void SweepAndPrune::refreshEndpoints(uint32_t axis)
+{
+	auto& endpoints = m_endpoints[axis];
+	if (!m_removedProxies.empty())
+	{
+		endpoints.erase(std::remove_if(std::begin(endpoints), std::end(endpoints), [this](const Endpoint& endpoint)
+			{
+				return !m_alive[getProxy(endpoint)];
+			}), std::end(endpoints));
+	}
+
+	for (auto& endpoint : endpoints)
+	{
+		const auto& box = m_boxes[getProxy(endpoint)];
+		endpoint.value = isMax(endpoint) ? box.max[axis] : box.min[axis];
+	}
+
+	// new ones start past all others, so they dont overlap anything yet
+	for (const auto& proxy : m_insertedProxies)
+	{
+		if (!m_alive[proxy])
+			continue;
+
+		const auto& box = m_boxes[proxy];
+		endpoints.push_back({ box.min[axis], proxy << 1 });
+		endpoints.push_back({ box.max[axis], (proxy << 1) | 1 });
+	}
+}
+
+void SweepAndPrune::sortEndpoints(uint32_t axis)
+{
+	auto& endpoints = m_endpoints[axis];
+	for (size_t index = 1; index < endpoints.size(); ++index)
+	{
+		const Endpoint endpoint = endpoints[index];
+
+		size_t place = index;
+		for (; place > 0 && isBefore(endpoint, endpoints[place - 1]); --place)
+		{
+			const Endpoint passed = endpoints[place - 1];
+			if (isMax(endpoint) != isMax(passed))
+			{
+				// min got before max so boxes may overlap now, other axis
+				// may not be sorted yet, but boxes already have new values
+				if (isMax(passed))
+				{
+					if (overlaps(getProxy(endpoint), getProxy(passed)))
+						addPair(getProxy(endpoint), getProxy(passed));
+				}
+				else
+				{
+					removePair(getProxy(endpoint), getProxy(passed));
+				}
+			}
+			endpoints[place] = passed;
+		}
+		endpoints[place] = endpoint;
+	}
+}
+
+void SweepAndPrune::rebuild()
+{
+	for (auto& overlaps : m_overlaps)
+		overlaps.clear();
+	m_pairCount = 0;
+
+	for (auto& endpoints : m_endpoints)
+		std::sort(std::begin(endpoints), std::end(endpoints), isBefore);
+
+	// boxes open on X at the moment are tested whole
+	std::vector<uint32_t> openProxies;
+	for (const auto& endpoint : m_endpoints[0])
+	{
+		const uint32_t proxy = getProxy(endpoint);
+		if (isMax(endpoint))
+		{
+			*std::find(std::begin(openProxies), std::end(openProxies), proxy) = openProxies.back();
+			openProxies.pop_back();
+			continue;
+		}
+
+		for (const auto& other : openProxies)
+		{
+			if (overlaps(proxy, other))
+				addPair(proxy, other);
+		}
+		openProxies.push_back(proxy);
+	}
+}
+
+bool SweepAndPrune::overlaps(uint32_t first, uint32_t second) const
+{
+	const auto& firstBox = m_boxes[first];
+	const auto& secondBox = m_boxes[second];
+
+	return firstBox.min.x <= secondBox.max.x && secondBox.min.x <= firstBox.max.x &&
+		firstBox.min.y <= secondBox.max.y && secondBox.min.y <= firstBox.max.y;
+}
+
+void SweepAndPrune::addPair(uint32_t first, uint32_t second)
+{
+	// same pair may start on both axes in one commit
+	auto& firstOverlaps = m_overlaps[first];
+	if (std::find(std::begin(firstOverlaps), std::end(firstOverlaps), second) != std::end(firstOverlaps))
+		return;
+
+	firstOverlaps.push_back(second);
+	m_overlaps[second].push_back(first);
+	++m_pairCount;
+}
+
+void SweepAndPrune::removePair(uint32_t first, uint32_t second)
+{
+	auto& firstOverlaps = m_overlaps[first];
+	auto place = std::find(std::begin(firstOverlaps), std::end(firstOverlaps), second);
+	if (place == std::end(firstOverlaps))
+		return;
+
+	*place = firstOverlaps.back();
+	firstOverlaps.pop_back();
+
+	auto& secondOverlaps = m_overlaps[second];
+	*std::find(std::begin(secondOverlaps), std::end(secondOverlaps), first) = secondOverlaps.back();
+	secondOverlaps.pop_back();
+	--m_pairCount;
+}
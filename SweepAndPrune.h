@@ -0,0 +1,67 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/*
+*	Boxes on XZ plane kept as sorted endpoints on both axes.
+*	Boxes move little between frames, so endpoints are nearly sorted
+*	and insertion sort fixes them with few swaps. Every swap of min
+*	and max of two boxes starts or ends their overlap on that axis,
+*	so overlapping pairs are kept between frames and only changed by it.
+*	Proxy keeps its id until removed, ids of removed ones are reused.
+*/
+class SweepAndPrune
+{
+public:
+	void clear();
+
+	uint32_t insert(const glm::vec2& min, const glm::vec2& max);
+	void update(uint32_t proxy, const glm::vec2& min, const glm::vec2& max);
+	void remove(uint32_t proxy);
+	// sorts endpoints and updates pairs after all changes of frame
+	void commit();
+
+	// proxies overlapping this one since last commit
+	const std::vector<uint32_t>& getOverlaps(uint32_t proxy) const;
+	uint32_t getPairCount() const;
+private:
+	struct Endpoint
+	{
+		float value;
+		// proxy shifted by one, lowest bit set for max
+		uint32_t data;
+	};
+	struct Box
+	{
+		glm::vec2 min;
+		glm::vec2 max;
+	};
+	static uint32_t getProxy(const Endpoint& endpoint);
+	static bool isMax(const Endpoint& endpoint);
+	// min goes before max of same value, so touching boxes overlap
+	static bool isBefore(const Endpoint& first, const Endpoint& second);
+
+	void refreshEndpoints(uint32_t axis);
+	void sortEndpoints(uint32_t axis);
+	// too many new boxes to move them one by one, all is sorted and swept again
+	void rebuild();
+
+	bool overlaps(uint32_t first, uint32_t second) const;
+	void addPair(uint32_t first, uint32_t second);
+	void removePair(uint32_t first, uint32_t second);
+
+	std::vector<Endpoint> m_endpoints[2];
+	std::vector<Box> m_boxes;
+	std::vector<bool> m_alive;
+	// both ways, so every proxy sees its pairs
+	std::vector<std::vector<uint32_t>> m_overlaps;
+	uint32_t m_pairCount = 0;
+
+	// endpoints get to arrays on commit
+	std::vector<uint32_t> m_insertedProxies;
+	// their endpoints leave arrays on commit, then ids can be taken again
+	std::vector<uint32_t> m_removedProxies;
+	std::vector<uint32_t> m_freeProxies;
+};
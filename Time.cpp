@@ -1,5 +1,6 @@
 #include "Time.h"
 #include <chrono>
+#include <cmath>
 
 Time::Time()
 {
@@ -14,9 +15,68 @@ double Time::deltaTime() const
 	return seconds;
 }
 
+double Time::fixedDeltaTime() const
+{
+	return Settings::Time::simulationStep;
+}
+
+double Time::interpolationAlpha() const
+{
+	return m_accumulator / Settings::Time::simulationStep;
+}
+
+uint64_t Time::simulationTicks() const
+{
+	return m_simulationTicks;
+}
+
+double Time::simulationTime() const
+{
+	return m_simulationTicks * Settings::Time::simulationStep;
+}
+
+void Time::setTimeScale(double timeScale)
+{
+	m_timeScale = timeScale;
+}
+
+double Time::getTimeScale() const
+{
+	return m_timeScale;
+}
+
 void Time::tick()
 {
 	auto currentTime = std::chrono::high_resolution_clock::now();
 	m_deltaTime = currentTime - m_lastTime;
 	m_lastTime = currentTime;
+
+	m_accumulator += m_deltaTime.count() * m_timeScale;
+
+	m_pendingSteps = 0;
+	while (m_accumulator >= Settings::Time::simulationStep && m_pendingSteps < Settings::Time::maxSubsteps)
+	{
+		m_accumulator -= Settings::Time::simulationStep;
+		++m_pendingSteps;
+	}
+
+	// we would never catch up, so just slow down
+	if (m_accumulator >= Settings::Time::simulationStep)
+		m_accumulator = std::fmod(m_accumulator, Settings::Time::simulationStep);
+}
+
+bool Time::stepSimulation()
+{
+	if (m_pendingSteps == 0)
+		return false;
+
+	--m_pendingSteps;
+	advanceSimulation();
+
+	return true;
+}
+
+void Time::advanceSimulation()
+{
+	++m_simulationTicks;
 }
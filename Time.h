@@ -1,14 +1,43 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
+
+namespace Settings
+{
+	namespace Time
+	{
+		constexpr double simulationStep = 1.0 / 50.0;	// seconds
+		// frame can catch up at most this many steps, rest of time is dropped
+		constexpr uint32_t maxSubsteps = 5;
+	}
+}
 
 class Time
 {
-	friend int main();
+	friend int main(int argc, char* argv[]);
 public:
 	Time();
+	// real frame time, for camera and such
 	double deltaTime() const;
+	// simulation advances only by fixed steps
+	double fixedDeltaTime() const;
+	// how far between last two simulation states the frame is
+	double interpolationAlpha() const;
+	uint64_t simulationTicks() const;
+	double simulationTime() const;
+
+	void setTimeScale(double timeScale);
+	double getTimeScale() const;
 private:
 	void tick();
+	bool stepSimulation();
+	void advanceSimulation();
+
 	std::chrono::duration<double> m_deltaTime;
 	std::chrono::high_resolution_clock::time_point m_lastTime;
-};
\ No newline at end of file
+
+	double m_timeScale = 1.0;
+	double m_accumulator = 0.0;
+	uint32_t m_pendingSteps = 0;
+	uint64_t m_simulationTicks = 0;
+};
@@ -0,0 +1,46 @@
+#include "UniformGrid.h"
+
+#include <cmath>
+
+UniformGrid::UniformGrid(float cellSize)
+	: m_cellSize(cellSize)
+{
+}
+
+void UniformGrid::clear()
+{
+	for (auto& [_, cell] : m_cells)
+		cell.clear();
+}
+
+void UniformGrid::insert(uint32_t index, const glm::vec2& min, const glm::vec2& max)
+{
+	const auto range = getCellRange(min, max);
+
+	for (int32_t x = range.minX; x <= range.maxX; ++x)
+	{
+		for (int32_t z = range.minZ; z <= range.maxZ; ++z)
+			m_cells[getCellKey(x, z)].push_back(index);
+	}
+}
+
+float UniformGrid::getCellSize() const
+{
+	return m_cellSize;
+}
+
+UniformGrid::CellRange UniformGrid::getCellRange(const glm::vec2& min, const glm::vec2& max) const
+{
+	CellRange range;
+	range.minX = static_cast<int32_t>(std::floor(min.x / m_cellSize));
+	range.minZ = static_cast<int32_t>(std::floor(min.y / m_cellSize));
+	range.maxX = static_cast<int32_t>(std::floor(max.x / m_cellSize));
+	range.maxZ = static_cast<int32_t>(std::floor(max.y / m_cellSize));
+
+	return range;
+}
+
+UniformGrid::CellKey UniformGrid::getCellKey(int32_t x, int32_t z)
+{
+	return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+}
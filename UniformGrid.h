@@ -0,0 +1,65 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace Settings
+{
+	namespace UniformGrid
+	{
+		constexpr float defaultCellSize = 25.0f;	// meters
+	}
+}
+
+/*
+*	Buckets indices by cells of XZ plane they overlap
+*	one index may be returned from more cells, so
+*	caller is responsible for filtering duplicates
+*/
+class UniformGrid
+{
+public:
+	UniformGrid(float cellSize = Settings::UniformGrid::defaultCellSize);
+
+	void clear();
+	void insert(uint32_t index, const glm::vec2& min, const glm::vec2& max);
+
+	template<class Function> void query(const glm::vec2& min, const glm::vec2& max, Function&& function) const;
+
+	float getCellSize() const;
+private:
+	using CellKey = uint64_t;
+	struct CellRange
+	{
+		int32_t minX, minZ;
+		int32_t maxX, maxZ;
+	};
+
+	CellRange getCellRange(const glm::vec2& min, const glm::vec2& max) const;
+	static CellKey getCellKey(int32_t x, int32_t z);
+
+	float m_cellSize;
+	// cells keep their capacity between frames
+	std::unordered_map<CellKey, std::vector<uint32_t>> m_cells;
+};
+
+template<class Function>
+void UniformGrid::query(const glm::vec2& min, const glm::vec2& max, Function&& function) const
+{
+	const auto range = getCellRange(min, max);
+
+	for (int32_t x = range.minX; x <= range.maxX; ++x)
+	{
+		for (int32_t z = range.minZ; z <= range.maxZ; ++z)
+		{
+			auto cell = m_cells.find(getCellKey(x, z));
+			if (cell == m_cells.end())
+				continue;
+
+			for (const auto& index : cell->second)
+				function(index);
+		}
+	}
+}
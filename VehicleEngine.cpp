@@ -0,0 +1,911 @@
+#include "VehicleEngine.h"
+#include "GlobalObjects.h"
+#include "VulkanInfo.h"
+#include "Utilities.h"
+#include "IntelligentDriver.h"
+
+#include <algorithm>
+#include <limits>
+#include <glm/gtc/constants.hpp>
+
+namespace
+{
+	template<class Type> void swapRemove(std::vector<Type>& values, uint32_t index)
+	{
+		values[index] = std::move(values.back());
+		values.pop_back();
+	}
+
+	float headingFromDirection(const glm::vec3& direction)
+	{
+		return std::atan2(direction.x, direction.z) + glm::half_pi<float>();
+	}
+}
+
+void VehicleEngine::initialize()
+{
+	Info::DrawInfo dInfo{};
+	dInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	dInfo.polygon = VK_POLYGON_MODE_FILL;
+	dInfo.lineWidth = 1.0f;
+
+	Info::ModelInfo mInfo;
+	mInfo.model = "resources/models/car2/car2.obj";
+
+	Info::GraphicsComponentCreateInfo createInfo;
+	createInfo.drawInfo = &dInfo;
+	createInfo.modelInfo = &mInfo;
+
+	m_instancedModel = App::vulkanBase.createInstancedModel(createInfo);
+}
+
+void VehicleEngine::spawnVehicle(const PathFinding::TravellSegments& travellSegments)
+{
+	const auto route = acquireRoute(App::laneGraph, travellSegments);
+	if (!route.valid())
+		return;
+
+	m_route.push_back(route);
+	m_id.push_back(m_nextId++);
+	m_routeCursor.push_back(0);
+	m_lane.push_back(0);
+	m_occupiedLane.push_back(getRoute(getVehicleCount() - 1).lanes.front());
+	m_leader.push_back(noVehicle);
+	m_leaderGap.push_back(std::numeric_limits<float>::max());
+	m_leaderSpeed.push_back(0.0f);
+	m_desiredSpeed.push_back(getDesiredSpeed(m_occupiedLane.back()));
+	m_reservedLane.push_back(noReservation);
+	m_passedConflicts.push_back(0);
+	m_blockedLane.push_back(noReservation);
+	m_promisedLane.push_back(noReservation);
+	m_awakePlace.push_back(static_cast<uint32_t>(m_awakeVehicles.size()));
+	m_sleepingBehind.push_back(noVehicle);
+	m_sleepingZone.push_back(ConflictZones::noZone);
+	m_sleepers.emplace_back();
+	m_distance.push_back(0.0f);
+	m_speed.push_back(0.0f);
+	m_acceleration.push_back(0.0f);
+	m_length.push_back(Settings::VehicleEngine::defaultLength);
+	m_width.push_back(Settings::VehicleEngine::defaultWidth);
+	m_position.emplace_back();
+	m_direction.emplace_back();
+	m_heading.push_back(0.0f);
+
+	const uint32_t index = getVehicleCount() - 1;
+	placeOnRoute(index);
+
+	// nothing to blend from yet
+	m_previousPosition.push_back(m_position[index]);
+	m_previousHeading.push_back(m_heading[index]);
+
+	m_laneEnterTime.push_back(m_time);
+	m_enteredLane.push_back(0);
+
+	m_laneOccupancy.insert(m_occupiedLane[index], index, [this](uint32_t vehicle) { return getLanePosition(vehicle); });
+	m_awakeVehicles.push_back(index);
+}
+
+void VehicleEngine::clear()
+{
+	// workers read cars and lane graph
+	finishRerouting();
+
+	m_routeTable.clear();
+	m_routeLookup.clear();
+
+	m_route.clear();
+	m_id.clear();
+	m_routeCursor.clear();
+	m_lane.clear();
+	m_occupiedLane.clear();
+	m_leader.clear();
+	m_leaderGap.clear();
+	m_leaderSpeed.clear();
+	m_desiredSpeed.clear();
+	m_reservedLane.clear();
+	m_passedConflicts.clear();
+	m_blockedLane.clear();
+	m_promisedLane.clear();
+	m_awakePlace.clear();
+	m_sleepingBehind.clear();
+	m_sleepingZone.clear();
+	m_sleepers.clear();
+	m_distance.clear();
+	m_speed.clear();
+	m_acceleration.clear();
+	m_length.clear();
+	m_width.clear();
+	m_position.clear();
+	m_direction.clear();
+	m_heading.clear();
+	m_previousPosition.clear();
+	m_previousHeading.clear();
+	m_laneEnterTime.clear();
+	m_enteredLane.clear();
+	m_awakeVehicles.clear();
+
+	m_time = 0.0;
+	m_nextReroutingTime = Settings::Rerouting::interval;
+	m_reroutingCursor = 0;
+	m_laneTravelTimes.reset(App::laneGraph);
+	m_laneOccupancy.reset(App::laneGraph.getLaneCount());
+	m_conflictZones.reset(App::laneGraph.getConflictZoneCount());
+}
+
+void VehicleEngine::update()
+{
+	storePreviousState();
+
+	// nobody moves until everyone decided, so all see state of previous step,
+	// cars woken meanwhile join in next step
+	const uint32_t awakeCount = static_cast<uint32_t>(m_awakeVehicles.size());
+	App::jobSystem.parallelFor(awakeCount, [this](uint32_t begin, uint32_t end) { findLeaders(begin, end); });
+	updateReservations(awakeCount);
+	App::jobSystem.parallelFor(awakeCount, [this](uint32_t begin, uint32_t end) { sense(begin, end); });
+	App::jobSystem.parallelFor(awakeCount, [this](uint32_t begin, uint32_t end) { act(begin, end); });
+	m_time += App::time.fixedDeltaTime();
+
+	updateLaneOccupancy();
+	measureLaneTimes();
+	updateSleeping(awakeCount);
+	removeFinished();
+	updateRerouting();
+}
+
+void VehicleEngine::publishInstances()
+{
+	const float alpha = static_cast<float>(App::time.interpolationAlpha());
+
+	m_instances.resize(getVehicleCount());
+	for (uint32_t index = 0; index < m_instances.size(); ++index)
+	{
+		// go shorter way around
+		float headingDelta = m_heading[index] - m_previousHeading[index];
+		headingDelta -= glm::two_pi<float>() * glm::round(headingDelta / glm::two_pi<float>());
+
+		auto& instance = m_instances[index];
+		instance.position = glm::mix(m_previousPosition[index], m_position[index], alpha);
+		instance.position.y += Settings::VehicleEngine::modelHeight;
+		instance.rotation = glm::vec3(m_previousHeading[index] + headingDelta * alpha, 0.0f, 0.0f);
+		instance.size = glm::vec3(Settings::VehicleEngine::modelScale);
+	}
+
+	App::vulkanBase.setModelInstances(m_instancedModel, m_instances);
+}
+
+uint32_t VehicleEngine::getVehicleCount() const
+{
+	return static_cast<uint32_t>(m_route.size());
+}
+
+bool VehicleEngine::isRerouting() const
+{
+	return !m_rerouteRequests.empty();
+}
+
+VehicleEngine::Route VehicleEngine::createRoute(const LaneGraph& laneGraph, std::vector<LaneId> lanes)
+{
+	Route route;
+	route.lanes = std::move(lanes);
+	for (const auto& lane : route.lanes)
+	{
+		const auto& lanePoints = laneGraph.getPoints(lane);
+		const auto& laneTable = laneGraph.getDistances(lane);
+
+		const float laneStart = route.points.empty() ? 0.0f :
+			route.distances.back() + glm::length(lanePoints.front() - route.points.back());
+		for (uint32_t index = 0; index < lanePoints.size(); ++index)
+		{
+			const auto& point = lanePoints[index];
+			// lanes share their end points
+			if (!route.points.empty() && approxSamePoints(route.points.back(), point))
+				continue;
+
+			route.points.push_back(point);
+			route.distances.push_back(laneStart + laneTable[index]);
+		}
+
+		if (!route.distances.empty())
+			route.laneEnds.push_back(route.distances.back());
+	}
+
+	route.hash = hashLanes(route.lanes);
+
+	return route;
+}
+
+size_t VehicleEngine::hashLanes(const std::vector<LaneId>& lanes)
+{
+	size_t hash = lanes.size();
+	for (const auto& lane : lanes)
+		hash ^= std::hash<LaneId>()(lane) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+	return hash;
+}
+
+SlotHandle VehicleEngine::acquireRoute(const LaneGraph& laneGraph, const PathFinding::TravellSegments& travellSegments)
+{
+	std::vector<LaneId> lanes;
+	lanes.reserve(travellSegments.size());
+	for (const auto& travellSegment : travellSegments)
+	{
+		if (travellSegment.exitLane() != invalidLaneId)
+			lanes.push_back(travellSegment.exitLane());
+	}
+
+	return acquireRoute(laneGraph, std::move(lanes));
+}
+
+SlotHandle VehicleEngine::acquireRoute(const LaneGraph& laneGraph, std::vector<LaneId> lanes)
+{
+	if (lanes.empty())
+		return SlotHandle();
+
+	// same lanes give same route, so its built only once
+	const auto hash = hashLanes(lanes);
+	const auto [first, last] = m_routeLookup.equal_range(hash);
+	for (auto lookup = first; lookup != last; ++lookup)
+	{
+		auto& sharedRoute = *m_routeTable.get(lookup->second);
+		if (sharedRoute.lanes == lanes)
+		{
+			++sharedRoute.users;
+			return lookup->second;
+		}
+	}
+
+	auto route = createRoute(laneGraph, std::move(lanes));
+	route.users = 1;
+	const auto handle = m_routeTable.insert(std::move(route));
+	m_routeLookup.emplace(hash, handle);
+
+	return handle;
+}
+
+void VehicleEngine::releaseRoute(SlotHandle handle)
+{
+	auto& route = *m_routeTable.get(handle);
+	if (--route.users != 0)
+		return;
+
+	const auto [first, last] = m_routeLookup.equal_range(route.hash);
+	for (auto lookup = first; lookup != last; ++lookup)
+	{
+		if (lookup->second.index == handle.index)
+		{
+			m_routeLookup.erase(lookup);
+			break;
+		}
+	}
+	m_routeTable.remove(handle);
+}
+
+const VehicleEngine::Route& VehicleEngine::getRoute(uint32_t index) const
+{
+	return *m_routeTable.get(m_route[index]);
+}
+
+float VehicleEngine::getDesiredSpeed(LaneId lane)
+{
+	return std::min(Settings::VehicleEngine::cruiseSpeed, App::laneGraph.getSpeedLimit(lane));
+}
+
+float VehicleEngine::getLanePosition(uint32_t index) const
+{
+	const uint32_t lane = m_lane[index];
+	const float laneStart = lane > 0 ? getRoute(index).laneEnds[lane - 1] : 0.0f;
+
+	return m_distance[index] - laneStart;
+}
+
+void VehicleEngine::storePreviousState()
+{
+	// sleeping cars stand where they were
+	for (const auto& index : m_awakeVehicles)
+	{
+		m_previousPosition[index] = m_position[index];
+		m_previousHeading[index] = m_heading[index];
+	}
+}
+
+void VehicleEngine::findLeaders(uint32_t begin, uint32_t end)
+{
+	for (uint32_t place = begin; place < end; ++place)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+
+		const auto& vehicles = m_laneOccupancy.getVehicles(m_occupiedLane[index]);
+		const uint32_t next = m_laneOccupancy.getPlace(index) + 1;
+		if (next == vehicles.size())
+		{
+			findLeaderAhead(index);
+			continue;
+		}
+
+		const uint32_t leader = vehicles[next];
+		m_leader[index] = leader;
+		m_leaderGap[index] = getLanePosition(leader) - getLanePosition(index) - (m_length[index] + m_length[leader]) / 2.0f;
+		m_leaderSpeed[index] = m_speed[leader];
+	}
+}
+
+void VehicleEngine::findLeaderAhead(uint32_t index)
+{
+	m_leader[index] = noVehicle;
+	m_leaderGap[index] = std::numeric_limits<float>::max();
+	m_leaderSpeed[index] = m_desiredSpeed[index];
+
+	const auto& route = getRoute(index);
+	float gap = route.laneEnds[m_lane[index]] - m_distance[index];
+	for (uint32_t lane = m_lane[index] + 1; lane < route.lanes.size() && gap < Settings::VehicleEngine::leaderLookAhead; ++lane)
+	{
+		const auto& vehicles = m_laneOccupancy.getVehicles(route.lanes[lane]);
+		if (!vehicles.empty())
+		{
+			const uint32_t leader = vehicles.front();
+			m_leader[index] = leader;
+			m_leaderGap[index] = gap + getLanePosition(leader) - (m_length[index] + m_length[leader]) / 2.0f;
+			m_leaderSpeed[index] = m_speed[leader];
+			return;
+		}
+
+		gap += route.laneEnds[lane] - route.laneEnds[lane - 1];
+	}
+}
+
+void VehicleEngine::updateReservations(uint32_t awakeCount)
+{
+	// one car after other, first to ask gets zones
+	for (uint32_t place = 0; place < awakeCount; ++place)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+		if (m_reservedLane[index] != noReservation)
+			leavePassedConflicts(index);
+		reserveConflictsAhead(index);
+	}
+}
+
+void VehicleEngine::reserveConflictsAhead(uint32_t index)
+{
+	const auto& route = getRoute(index);
+	const bool reserved = m_reservedLane[index] != noReservation;
+	const uint32_t firstLane = (reserved ? std::max(m_lane[index], m_reservedLane[index]) : m_lane[index]) + 1;
+	const float front = m_distance[index] + m_length[index] / 2.0f;
+	const float reservationDistance = getReservationDistance(index);
+	m_blockedLane[index] = noReservation;
+
+	for (uint32_t lane = firstLane; lane < route.lanes.size(); ++lane)
+	{
+		const float stopGap = route.laneEnds[lane - 1] - front;
+		if (stopGap > reservationDistance)
+			return;
+
+		const LaneId laneId = route.lanes[lane];
+		const auto conflicts = App::laneGraph.getConflicts(laneId);
+		if (conflicts.empty())
+			continue;
+		// car ahead gets there first
+		if (m_leaderGap[index] < stopGap)
+			return;
+
+		// car shouldnt end up standing in intersection, moving car ahead makes space
+		const bool hasSpaceAfter = m_leaderGap[index] - (route.laneEnds[lane] - front) >= m_length[index] ||
+			m_leaderSpeed[index] >= Settings::VehicleEngine::movingSpeed;
+		// one reservation at a time, previous one is let go of soon
+		if (!reserved && hasSpaceAfter)
+		{
+			if (m_conflictZones.findBlockingZone(conflicts, laneId) == ConflictZones::noZone)
+			{
+				m_conflictZones.enter(conflicts, laneId);
+				m_reservedLane[index] = lane;
+				m_passedConflicts[index] = 0;
+				m_promisedLane[index] = noReservation;
+				return;
+			}
+			if (m_conflictZones.wait(conflicts, laneId))
+				m_promisedLane[index] = lane;
+			m_blockedLane[index] = lane;
+		}
+
+		m_leaderGap[index] = stopGap;
+		m_leaderSpeed[index] = 0.0f;
+		return;
+	}
+}
+
+float VehicleEngine::getReservationDistance(uint32_t index) const
+{
+	using namespace Settings::IntelligentDriver;
+	const float speed = m_speed[index];
+
+	return minimumGap + Settings::VehicleEngine::reservationMargin + speed * timeHeadway + speed * speed / (2.0f * comfortableDeceleration);
+}
+
+void VehicleEngine::leavePassedConflicts(uint32_t index)
+{
+	const auto& route = getRoute(index);
+	const uint32_t reservedLane = m_reservedLane[index];
+	const auto conflicts = App::laneGraph.getConflicts(route.lanes[reservedLane]);
+
+	// rear of car from start of reserved lane
+	const float laneStart = reservedLane > 0 ? route.laneEnds[reservedLane - 1] : 0.0f;
+	const float passed = m_distance[index] - m_length[index] / 2.0f - laneStart;
+
+	auto wake = [this](uint32_t vehicle) { wakeUp(vehicle); };
+	auto& passedConflicts = m_passedConflicts[index];
+	for (; passedConflicts < conflicts.size() && conflicts[passedConflicts].end <= passed; ++passedConflicts)
+		m_conflictZones.leave(conflicts[passedConflicts], wake);
+
+	if (passedConflicts == conflicts.size())
+	{
+		m_reservedLane[index] = noReservation;
+		passedConflicts = 0;
+	}
+}
+
+void VehicleEngine::leaveConflicts(uint32_t index)
+{
+	if (m_reservedLane[index] == noReservation)
+		return;
+
+	auto wake = [this](uint32_t vehicle) { wakeUp(vehicle); };
+	const auto conflicts = App::laneGraph.getConflicts(getRoute(index).lanes[m_reservedLane[index]]);
+	for (uint32_t conflict = m_passedConflicts[index]; conflict < conflicts.size(); ++conflict)
+		m_conflictZones.leave(conflicts[conflict], wake);
+
+	m_reservedLane[index] = noReservation;
+	m_passedConflicts[index] = 0;
+}
+
+void VehicleEngine::stopWaiting(uint32_t index)
+{
+	if (m_promisedLane[index] == noReservation)
+		return;
+
+	const LaneId lane = getRoute(index).lanes[m_promisedLane[index]];
+	m_conflictZones.stopWaiting(App::laneGraph.getConflicts(lane), lane, [this](uint32_t vehicle) { wakeUp(vehicle); });
+	m_promisedLane[index] = noReservation;
+}
+
+void VehicleEngine::sense(uint32_t begin, uint32_t end)
+{
+	// awake cars are spread over arrays, model runs on packed copies of them
+	constexpr uint32_t batchSize = 256;
+	float gaps[batchSize];
+	float speeds[batchSize];
+	float leaderSpeeds[batchSize];
+	float desiredSpeeds[batchSize];
+	float accelerations[batchSize];
+
+	for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += batchSize)
+	{
+		const uint32_t count = std::min(batchSize, end - batchBegin);
+		for (uint32_t offset = 0; offset < count; ++offset)
+		{
+			const uint32_t index = m_awakeVehicles[batchBegin + offset];
+			gaps[offset] = m_leaderGap[index];
+			speeds[offset] = m_speed[index];
+			leaderSpeeds[offset] = m_leaderSpeed[index];
+			desiredSpeeds[offset] = m_desiredSpeed[index];
+		}
+
+		IntelligentDriver::computeAccelerations(gaps, speeds, leaderSpeeds, desiredSpeeds, accelerations, count);
+
+		for (uint32_t offset = 0; offset < count; ++offset)
+			m_acceleration[m_awakeVehicles[batchBegin + offset]] = accelerations[offset];
+	}
+}
+
+void VehicleEngine::act(uint32_t begin, uint32_t end)
+{
+	const float deltaTime = static_cast<float>(App::time.fixedDeltaTime());
+
+	for (uint32_t place = begin; place < end; ++place)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+		m_speed[index] = std::max(m_speed[index] + m_acceleration[index] * deltaTime, 0.0f);
+		m_distance[index] += m_speed[index] * deltaTime;
+		placeOnRoute(index);
+	}
+}
+
+void VehicleEngine::placeOnRoute(uint32_t index)
+{
+	const auto& route = getRoute(index);
+	const float distance = m_distance[index];
+
+	auto& cursor = m_routeCursor[index];
+	cursor = ArcLength::advanceSegment(route.distances, distance, cursor);
+
+	auto& lane = m_lane[index];
+	while (lane + 1 < route.laneEnds.size() && route.laneEnds[lane] <= distance)
+		++lane;
+
+	const auto sample = ArcLength::sampleOnSegment(route.points, route.distances, distance, cursor);
+	m_position[index] = sample.point;
+	if (sample.tangent != glm::vec3(0.0f))
+	{
+		m_direction[index] = sample.tangent;
+		m_heading[index] = headingFromDirection(sample.tangent);
+	}
+}
+
+void VehicleEngine::updateLaneOccupancy()
+{
+	auto positionOf = [this](uint32_t vehicle) { return getLanePosition(vehicle); };
+
+	for (const auto& index : m_awakeVehicles)
+	{
+		const LaneId lane = getRoute(index).lanes[m_lane[index]];
+		if (lane == m_occupiedLane[index])
+		{
+			if (m_speed[index] > 0.0f)
+				m_laneOccupancy.markUnsorted(lane);
+			continue;
+		}
+
+		m_laneOccupancy.remove(m_occupiedLane[index], index);
+		m_occupiedLane[index] = lane;
+		m_laneOccupancy.insert(lane, index, positionOf);
+
+		m_desiredSpeed[index] = getDesiredSpeed(lane);
+	}
+
+	m_laneOccupancy.sortLanes(positionOf);
+}
+
+void VehicleEngine::updateSleeping(uint32_t awakeCount)
+{
+	// moving cars wake ones behind them
+	for (uint32_t place = 0; place < awakeCount; ++place)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+		if (m_speed[index] > 0.0f)
+			wakeSleepersOf(index);
+	}
+
+	// standing cars that wont move before what holds them changes,
+	// last places go first, so sleeping car is replaced by visited one
+	for (uint32_t place = awakeCount; place-- > 0;)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+		if (m_speed[index] > 0.0f || m_acceleration[index] > 0.0f)
+			continue;
+
+		if (m_blockedLane[index] != noReservation)
+		{
+			// zone may have got free later in step
+			const uint32_t zone = getBlockingZone(index);
+			if (zone == ConflictZones::noZone)
+				continue;
+
+			putToSleep(index);
+			m_sleepingZone[index] = zone;
+			m_conflictZones.addSleeper(zone, index);
+			continue;
+		}
+
+		const uint32_t leader = m_leader[index];
+		if (leader == noVehicle || m_speed[leader] > 0.0f)
+			continue;
+
+		putToSleep(index);
+		m_sleepingBehind[index] = leader;
+		m_sleepers[leader].push_back(index);
+	}
+}
+
+uint32_t VehicleEngine::getBlockingZone(uint32_t index) const
+{
+	const LaneId lane = getRoute(index).lanes[m_blockedLane[index]];
+
+	return m_conflictZones.findBlockingZone(App::laneGraph.getConflicts(lane), lane);
+}
+
+void VehicleEngine::putToSleep(uint32_t index)
+{
+	// last awake car takes its place
+	const uint32_t place = m_awakePlace[index];
+	const uint32_t movedIndex = m_awakeVehicles.back();
+	m_awakeVehicles[place] = movedIndex;
+	m_awakePlace[movedIndex] = place;
+	m_awakeVehicles.pop_back();
+
+	m_awakePlace[index] = asleep;
+	m_acceleration[index] = 0.0f;
+}
+
+void VehicleEngine::wakeUp(uint32_t index)
+{
+	if (m_awakePlace[index] != asleep)
+		return;
+
+	m_sleepingBehind[index] = noVehicle;
+	m_sleepingZone[index] = ConflictZones::noZone;
+
+	m_awakePlace[index] = static_cast<uint32_t>(m_awakeVehicles.size());
+	m_awakeVehicles.push_back(index);
+}
+
+void VehicleEngine::wakeSleepersOf(uint32_t index)
+{
+	for (const auto& sleeper : m_sleepers[index])
+		wakeUp(sleeper);
+	m_sleepers[index].clear();
+}
+
+void VehicleEngine::leaveWakeList(uint32_t index)
+{
+	const uint32_t leader = m_sleepingBehind[index];
+	if (leader != noVehicle)
+	{
+		auto& sleepers = m_sleepers[leader];
+		sleepers.erase(std::find(std::begin(sleepers), std::end(sleepers), index));
+	}
+
+	const uint32_t zone = m_sleepingZone[index];
+	if (zone != ConflictZones::noZone)
+		m_conflictZones.removeSleeper(zone, index);
+}
+
+void VehicleEngine::renameVehicle(uint32_t index, uint32_t newIndex)
+{
+	m_laneOccupancy.rename(m_occupiedLane[index], index, newIndex);
+
+	if (m_awakePlace[index] != asleep)
+		m_awakeVehicles[m_awakePlace[index]] = newIndex;
+
+	const uint32_t leader = m_sleepingBehind[index];
+	if (leader != noVehicle)
+	{
+		auto& sleepers = m_sleepers[leader];
+		*std::find(std::begin(sleepers), std::end(sleepers), index) = newIndex;
+	}
+
+	const uint32_t zone = m_sleepingZone[index];
+	if (zone != ConflictZones::noZone)
+		m_conflictZones.renameSleeper(zone, index, newIndex);
+
+	for (const auto& sleeper : m_sleepers[index])
+		m_sleepingBehind[sleeper] = newIndex;
+}
+
+void VehicleEngine::removeFinished()
+{
+	// only moving cars get to end
+	for (uint32_t place = static_cast<uint32_t>(m_awakeVehicles.size()); place-- > 0;)
+	{
+		const uint32_t index = m_awakeVehicles[place];
+		if (m_distance[index] >= getRoute(index).distances.back())
+			removeVehicle(index);
+	}
+}
+
+void VehicleEngine::removeVehicle(uint32_t index)
+{
+	leaveConflicts(index);
+	stopWaiting(index);
+	wakeSleepersOf(index);
+	if (m_awakePlace[index] == asleep)
+		leaveWakeList(index);
+	else
+		putToSleep(index);
+	releaseRoute(m_route[index]);
+
+	// last car takes its index
+	const uint32_t lastIndex = getVehicleCount() - 1;
+	m_laneOccupancy.remove(m_occupiedLane[index], index);
+	if (index != lastIndex)
+		renameVehicle(lastIndex, index);
+
+	swapRemove(m_route, index);
+	swapRemove(m_id, index);
+	swapRemove(m_routeCursor, index);
+	swapRemove(m_lane, index);
+	swapRemove(m_occupiedLane, index);
+	swapRemove(m_leader, index);
+	swapRemove(m_leaderGap, index);
+	swapRemove(m_leaderSpeed, index);
+	swapRemove(m_desiredSpeed, index);
+	swapRemove(m_reservedLane, index);
+	swapRemove(m_passedConflicts, index);
+	swapRemove(m_blockedLane, index);
+	swapRemove(m_promisedLane, index);
+	swapRemove(m_awakePlace, index);
+	swapRemove(m_sleepingBehind, index);
+	swapRemove(m_sleepingZone, index);
+	swapRemove(m_sleepers, index);
+	swapRemove(m_distance, index);
+	swapRemove(m_speed, index);
+	swapRemove(m_acceleration, index);
+	swapRemove(m_length, index);
+	swapRemove(m_width, index);
+	swapRemove(m_position, index);
+	swapRemove(m_direction, index);
+	swapRemove(m_heading, index);
+	swapRemove(m_previousPosition, index);
+	swapRemove(m_previousHeading, index);
+	swapRemove(m_laneEnterTime, index);
+	swapRemove(m_enteredLane, index);
+}
+
+void VehicleEngine::measureLaneTimes()
+{
+	// sleeping cars dont change lanes
+	for (const auto& index : m_awakeVehicles)
+	{
+		if (m_lane[index] == m_enteredLane[index])
+			continue;
+
+		const float timeOnLane = static_cast<float>(m_time - m_laneEnterTime[index]);
+		m_laneTravelTimes.addSample(getRoute(index).lanes[m_enteredLane[index]], timeOnLane);
+		m_enteredLane[index] = m_lane[index];
+		m_laneEnterTime[index] = m_time;
+	}
+}
+
+void VehicleEngine::measureWaiting()
+{
+	for (const auto& lane : m_laneOccupancy.getOccupiedLanes())
+	{
+		const uint32_t front = m_laneOccupancy.getVehicles(lane).back();
+		m_laneTravelTimes.addWaiting(lane, static_cast<float>(m_time - m_laneEnterTime[front]));
+	}
+}
+
+void VehicleEngine::updateRerouting()
+{
+	if (!Settings::Rerouting::enabled)
+		return;
+
+	if (!m_rerouteRequests.empty())
+	{
+		if (!m_reroutingCounter.finished())
+			return;
+
+		// rethrows what replanning threw
+		App::jobSystem.wait(m_reroutingCounter);
+		applyReroutes();
+	}
+
+	if (m_time < m_nextReroutingTime)
+		return;
+	m_nextReroutingTime = m_time + Settings::Rerouting::interval;
+
+	measureWaiting();
+	m_laneTravelTimes.update();
+	startRerouting();
+}
+
+void VehicleEngine::startRerouting()
+{
+	const uint32_t vehicleCount = getVehicleCount();
+	if (vehicleCount == 0)
+		return;
+
+	uint32_t visited = 0;
+	for (; visited < vehicleCount && m_rerouteRequests.size() < Settings::Rerouting::vehiclesPerPass; ++visited)
+	{
+		const uint32_t index = (m_reroutingCursor + visited) % vehicleCount;
+		const auto& route = getRoute(index);
+		const uint32_t lane = m_lane[index];
+		// nothing to choose between current and last lane
+		if (lane + 2 >= route.lanes.size())
+			continue;
+
+		RerouteRequest request;
+		request.vehicleId = m_id[index];
+		request.currentLane = route.lanes[lane];
+		request.endLane = route.lanes.back();
+		request.remainingLanes.assign(std::begin(route.lanes) + lane + 1, std::end(route.lanes));
+		m_rerouteRequests.push_back(std::move(request));
+	}
+	m_reroutingCursor = (m_reroutingCursor + visited) % vehicleCount;
+
+	if (m_rerouteRequests.empty())
+		return;
+
+	m_reroutingTravelTimes = m_laneTravelTimes.getTravelTimes();
+	const uint32_t requestCount = static_cast<uint32_t>(m_rerouteRequests.size());
+	for (uint32_t begin = 0; begin < requestCount; begin += Settings::Rerouting::vehiclesPerJob)
+	{
+		const uint32_t end = std::min(begin + Settings::Rerouting::vehiclesPerJob, requestCount);
+		// simulation waits never pick them up, so step does not wait for search
+		App::jobSystem.submitBackground([this, begin, end]
+			{
+				for (uint32_t index = begin; index < end; ++index)
+					replanRoute(m_rerouteRequests[index], m_reroutingTravelTimes);
+			}, m_reroutingCounter);
+	}
+}
+
+void VehicleEngine::replanRoute(RerouteRequest& request, const std::vector<float>& travelTimes)
+{
+	const auto travellSegments = PathFinding::findRemainingRoute(App::laneGraph, request.currentLane, request.endLane, travelTimes);
+	// first one is current lane
+	if (travellSegments.size() < 2)
+		return;
+
+	std::vector<LaneId> lanes;
+	lanes.reserve(travellSegments.size() - 1);
+	for (auto travellSegment = std::begin(travellSegments) + 1; travellSegment != std::end(travellSegments); ++travellSegment)
+		lanes.push_back(travellSegment->exitLane());
+	if (lanes == request.remainingLanes)
+		return;
+
+	auto travelTimeOf = [&travelTimes](const std::vector<LaneId>& lanes)
+	{
+		float travelTime = 0.0f;
+		for (const auto& lane : lanes)
+			travelTime += travelTimes[lane];
+
+		return travelTime;
+	};
+	// so cars dont flip between two about as fast routes
+	if (travelTimeOf(lanes) < travelTimeOf(request.remainingLanes) * (1.0f - Settings::Rerouting::minImprovement))
+		request.newLanes = std::move(lanes);
+}
+
+void VehicleEngine::applyReroutes()
+{
+	std::unordered_map<uint32_t, uint32_t> vehicleIndices;
+	for (const auto& request : m_rerouteRequests)
+	{
+		if (request.newLanes.empty())
+			continue;
+
+		if (vehicleIndices.empty())
+		{
+			for (uint32_t index = 0; index < getVehicleCount(); ++index)
+				vehicleIndices[m_id[index]] = index;
+		}
+		auto vehicleIndex = vehicleIndices.find(request.vehicleId);
+		if (vehicleIndex == vehicleIndices.end())
+			continue;
+
+		const uint32_t index = vehicleIndex->second;
+		const auto& route = getRoute(index);
+		const uint32_t lane = m_lane[index];
+		// car moved to other lane meanwhile
+		if (route.lanes[lane] != request.currentLane ||
+			!std::equal(std::begin(route.lanes) + lane + 1, std::end(route.lanes), std::begin(request.remainingLanes), std::end(request.remainingLanes)))
+			continue;
+
+		// driven part stays same, so distance and cursor stay valid
+		std::vector<LaneId> lanes(std::begin(route.lanes), std::begin(route.lanes) + lane + 1);
+		lanes.insert(std::end(lanes), std::begin(request.newLanes), std::end(request.newLanes));
+
+		// car may be too close to stop before other lane, so it keeps one it claimed
+		const uint32_t reservedLane = m_reservedLane[index];
+		if (reservedLane != noReservation && (reservedLane >= lanes.size() || lanes[reservedLane] != route.lanes[reservedLane]))
+			continue;
+
+		const uint32_t promisedLane = m_promisedLane[index];
+		if (promisedLane != noReservation && (promisedLane >= lanes.size() || lanes[promisedLane] != route.lanes[promisedLane]))
+			stopWaiting(index);
+		// what it waits for may not be on new route
+		if (m_awakePlace[index] == asleep)
+		{
+			leaveWakeList(index);
+			wakeUp(index);
+		}
+
+		const auto newRoute = acquireRoute(App::laneGraph, std::move(lanes));
+		if (!newRoute.valid())
+			continue;
+
+		releaseRoute(m_route[index]);
+		m_route[index] = newRoute;
+	}
+
+	m_rerouteRequests.clear();
+}
+
+void VehicleEngine::finishRerouting()
+{
+	if (m_rerouteRequests.empty())
+		return;
+
+	App::jobSystem.wait(m_reroutingCounter);
+	m_rerouteRequests.clear();
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include "BasicGeometry.h"
+#include "ArcLength.h"
+#include "RoadPathFinder.h"
+#include "LaneTravelTimes.h"
+#include "LaneOccupancy.h"
+#include "ConflictZones.h"
+#include "SlotMap.h"
+#include "VulkanBase.h"
+#include "JobSystem.h"
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace Settings
+{
+	namespace VehicleEngine
+	{
+		constexpr float defaultLength = 3.0f;				// meters
+		constexpr float defaultWidth = 2.0f;				// meters
+		// top speed driver wants, lower on slower lanes
+		constexpr float cruiseSpeed = 50.0f / 3.6f;			// meters per second
+		// car claims intersection lane this much sooner than it needs to stop before it
+		constexpr float reservationMargin = 5.0f;			// meters
+		// slower car counts as standing
+		constexpr float movingSpeed = 1.0f;					// meters per second
+		// car ahead is looked for this far along route
+		constexpr float leaderLookAhead = 100.0f;			// meters
+		// model is scaled and lifted so it isnt dug in the ground
+		constexpr float modelScale = 3.0f;
+		constexpr float modelHeight = 0.3f * modelScale;
+	}
+	namespace Rerouting
+	{
+		constexpr bool enabled = true;
+		// seconds of simulation between passes
+		constexpr float interval = 2.0f;
+		// cars replanning rest of route in one pass
+		constexpr uint32_t vehiclesPerPass = 64;
+		// routes searched by one job
+		constexpr uint32_t vehiclesPerJob = 8;
+		// new route is taken only when its faster by this part
+		constexpr float minImprovement = 0.1f;
+	}
+}
+
+/*
+*	Cars kept as structure of arrays, index is the car,
+*	fleet is updated in plain loops over the arrays.
+*	Standing car that waits for car ahead or for conflict zone
+*	falls asleep and is skipped until what it waits for changes.
+*/
+class VehicleEngine
+{
+public:
+	// needs vulkan, loads shared car model
+	void initialize();
+
+	// car drives along lanes of travell segments and vanishes at the end,
+	// lanes are taken from App::laneGraph
+	void spawnVehicle(const PathFinding::TravellSegments& travellSegments);
+	// also after App::laneGraph is rebuilt, measured lane times go by its ids
+	void clear();
+
+	// one fixed simulation step
+	void update();
+	// main thread, interpolated transforms for next render snapshot
+	void publishInstances();
+
+	uint32_t getVehicleCount() const;
+	// replanning pass runs on workers
+	bool isRerouting() const;
+private:
+	static constexpr uint32_t noVehicle = UINT32_MAX;
+	static constexpr uint32_t noReservation = UINT32_MAX;
+	static constexpr uint32_t asleep = UINT32_MAX;
+
+	// never changes once created, cars on same lanes share it
+	struct Route
+	{
+		std::vector<LaneId> lanes;
+		// lane points joined, so car never looks up lanes while driving
+		Points points;
+		// arc length at every point, joined from lane tables
+		ArcLength::Table distances;
+		// arc length where every lane of route ends
+		std::vector<float> laneEnds;
+
+		size_t hash = 0;
+		uint32_t users = 0;
+	};
+	static Route createRoute(const LaneGraph& laneGraph, std::vector<LaneId> lanes);
+	static size_t hashLanes(const std::vector<LaneId>& lanes);
+	// invalid when no lane has any points
+	SlotHandle acquireRoute(const LaneGraph& laneGraph, const PathFinding::TravellSegments& travellSegments);
+	SlotHandle acquireRoute(const LaneGraph& laneGraph, std::vector<LaneId> lanes);
+	void releaseRoute(SlotHandle handle);
+	const Route& getRoute(uint32_t index) const;
+	// distance from start of lane car is on
+	float getLanePosition(uint32_t index) const;
+	static float getDesiredSpeed(LaneId lane);
+
+	void storePreviousState();
+	// over awake cars, car ahead in lane or first one on next lanes of route
+	void findLeaders(uint32_t begin, uint32_t end);
+	void findLeaderAhead(uint32_t index);
+	// intersection lanes cross, car claims their conflicts before entering
+	// and stands before lane like behind car when it cant
+	void updateReservations(uint32_t awakeCount);
+	void reserveConflictsAhead(uint32_t index);
+	// distance car needs to stop without hard braking
+	float getReservationDistance(uint32_t index) const;
+	void leavePassedConflicts(uint32_t index);
+	void leaveConflicts(uint32_t index);
+	void stopWaiting(uint32_t index);
+	void sense(uint32_t begin, uint32_t end);
+	void act(uint32_t begin, uint32_t end);
+	void placeOnRoute(uint32_t index);
+	void updateLaneOccupancy();
+	// first awake count cars were simulated in step, ones after got woken during it
+	void updateSleeping(uint32_t awakeCount);
+	// zone that keeps car before lane it waits at, noZone when none does
+	uint32_t getBlockingZone(uint32_t index) const;
+	void putToSleep(uint32_t index);
+	// car isnt in any wake list anymore
+	void wakeUp(uint32_t index);
+	void wakeSleepersOf(uint32_t index);
+	void leaveWakeList(uint32_t index);
+	// other car takes index
+	void renameVehicle(uint32_t index, uint32_t newIndex);
+	void removeFinished();
+	void removeVehicle(uint32_t index);
+
+	// car replans lanes after one it drives, with travel times measured when pass started
+	struct RerouteRequest
+	{
+		uint32_t vehicleId = 0;
+		LaneId currentLane = invalidLaneId;
+		LaneId endLane = invalidLaneId;
+		std::vector<LaneId> remainingLanes;
+		// empty when old ones are good enough
+		std::vector<LaneId> newLanes;
+	};
+	void measureLaneTimes();
+	// cars standing on lane entered it after one in front
+	void measureWaiting();
+	// never waits for workers, results are taken in first step after they finish
+	void updateRerouting();
+	void startRerouting();
+	static void replanRoute(RerouteRequest& request, const std::vector<float>& travelTimes);
+	void applyReroutes();
+	void finishRerouting();
+
+	SlotMap<Route> m_routeTable;
+	std::unordered_multimap<size_t, SlotHandle> m_routeLookup;
+
+	// one entry per car in every array
+	std::vector<SlotHandle> m_route;
+	// stays with car when others are removed
+	std::vector<uint32_t> m_id;
+	// segment of route car is on, offset in it is distance minus arc length at segment start
+	std::vector<uint32_t> m_routeCursor;
+	// lane of route car is on
+	std::vector<uint32_t> m_lane;
+	// lane id car is listed on in occupancy
+	std::vector<LaneId> m_occupiedLane;
+	// car ahead, noVehicle when theres none close
+	std::vector<uint32_t> m_leader;
+	// free space to car ahead along route
+	std::vector<float> m_leaderGap;
+	std::vector<float> m_leaderSpeed;
+	// speed limit of lane, capped by cruise speed
+	std::vector<float> m_desiredSpeed;
+	// lane of route car claimed conflicts of, noReservation when none
+	std::vector<uint32_t> m_reservedLane;
+	// conflicts of that lane car got past
+	std::vector<uint32_t> m_passedConflicts;
+	// lane of route car stands before since its zones are taken, set every step
+	std::vector<uint32_t> m_blockedLane;
+	// lane of route car has zones promised for
+	std::vector<uint32_t> m_promisedLane;
+	// place in awake cars, asleep when sleeping
+	std::vector<uint32_t> m_awakePlace;
+	// what sleeping car waits for, car ahead or zone
+	std::vector<uint32_t> m_sleepingBehind;
+	std::vector<uint32_t> m_sleepingZone;
+	// cars sleeping behind this one
+	std::vector<std::vector<uint32_t>> m_sleepers;
+	// arc length travelled on route
+	std::vector<float> m_distance;
+	std::vector<float> m_speed;
+	std::vector<float> m_acceleration;
+	std::vector<float> m_length;
+	std::vector<float> m_width;
+	// derived from route after every step
+	std::vector<glm::vec3> m_position;
+	std::vector<glm::vec3> m_direction;
+	std::vector<float> m_heading;
+	// state before last step, drawn state is blended towards current one
+	std::vector<glm::vec3> m_previousPosition;
+	std::vector<float> m_previousHeading;
+	// when car got on its lane and which one of route it was
+	std::vector<double> m_laneEnterTime;
+	std::vector<uint32_t> m_enteredLane;
+
+	// cars simulated in next step
+	std::vector<uint32_t> m_awakeVehicles;
+	LaneOccupancy m_laneOccupancy;
+	ConflictZones m_conflictZones;
+
+	uint32_t m_nextId = 0;
+	// simulation seconds since clear
+	double m_time = 0.0;
+
+	LaneTravelTimes m_laneTravelTimes;
+	double m_nextReroutingTime = 0.0;
+	// cars take turns in replanning
+	uint32_t m_reroutingCursor = 0;
+	// workers own these until counter finishes
+	std::vector<RerouteRequest> m_rerouteRequests;
+	std::vector<float> m_reroutingTravelTimes;
+	JobCounter m_reroutingCounter;
+
+	uint32_t m_instancedModel = 0;
+	std::vector<VulkanBase::ModelInstance> m_instances;
+};
@@ -11,7 +11,6 @@
 
 #include "GlobalObjects.h"
 #include "Transformations.h"
-#include "GlobalSynchronization.h"
 #include "GraphicsObjects.h"
 #include "Models.h"
 #include "Utilities.h"
@@ -19,6 +18,7 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION    
 #include <stb/stb_image.h>
@@ -159,14 +159,27 @@ void VulkanBase::populateDebugMessenger(VkDebugUtilsMessengerCreateInfoEXT& mess
 	messengerInfo.pUserData = nullptr;
 }
 
-void VulkanBase::run()
+void VulkanBase::initialize()
 {
 	initVulkan();
 	initUI();
-	
-	mainLoop();
+}
+
+void VulkanBase::initHeadless()
+{
+	m_headless = true;
+
+	initGraphicsComponentCores();
+}
 
-	cleanUp();
+void VulkanBase::cleanUpHeadless()
+{
+	cleanUpGraphicsComponentCores();
+}
+
+bool VulkanBase::isHeadless() const
+{
+	return m_headless;
 }
 
 VkRenderPass VulkanBase::getRenderPass() const
@@ -193,11 +206,17 @@ pGraphicsComponentCore VulkanBase::createGrahicsComponentCore()
 
 void VulkanBase::updateGrahicsComponentCore(pGraphicsComponentCore& graphicsCore, const Info::GraphicsComponentCreateInfo& info)
 {
+	// nothing to load models into
+	if (m_headless)
+		return;
+
+	std::lock_guard renderLock(m_renderMutex);
 	graphicsCore->modelData = getModelDataFromInfo(info);
 }
 
 void VulkanBase::copyGraphicsComponentCore(const pGraphicsComponentCore& copyGraphicsCore, pGraphicsComponentCore& destinationGraphicsCore) const
 {
+	std::lock_guard renderLock(m_renderMutex);
 	*destinationGraphicsCore = *copyGraphicsCore;
 }
 pGraphicsComponentCore VulkanBase::copyCreateGraphicsComponentCore(const pGraphicsComponentCore& copyGraphicsCore)
@@ -214,15 +233,123 @@ void VulkanBase::deactivateGraphicsComponentCore(pGraphicsComponentCore& deactiv
 	// no error check
 	auto gComp = std::find(std::begin(m_activeGraphicsComponentCores), std::end(m_activeGraphicsComponentCores), deactivateCore);
 	m_activeGraphicsComponentCores.erase(gComp);
-	m_graphicsComponentCores.push(deactivateCore);
 
 	m_changedActiveComponentsSize = true;
 
 	// nulify
-	*deactivateCore = {};
+	if (m_headless)
+	{
+		*deactivateCore = {};
+		m_graphicsComponentCores.push(deactivateCore);
+	}
+	else
+	{
+		m_releasedGraphicsComponentCores.push_back(deactivateCore);
+	}
 	deactivateCore = nullptr;
 }
 
+uint32_t VulkanBase::createInstancedModel(const Info::GraphicsComponentCreateInfo& info)
+{
+	auto& instancedModel = m_instancedModels.emplace_back();
+	if (!m_headless)
+	{
+		std::lock_guard renderLock(m_renderMutex);
+		instancedModel.modelData = getModelDataFromInfo(info);
+	}
+
+	return static_cast<uint32_t>(m_instancedModels.size() - 1);
+}
+
+void VulkanBase::setModelInstances(uint32_t instancedModel, const std::vector<ModelInstance>& instances)
+{
+	if (m_headless)
+		return;
+
+	m_instancedModels[instancedModel].instances = instances;
+}
+
+void VulkanBase::storePreviousTransformations()
+{
+	for (auto& graphicsCore : m_activeGraphicsComponentCores)
+	{
+		if (graphicsCore->interpolate)
+		{
+			graphicsCore->previousTransformations.position = graphicsCore->transformations.position;
+			graphicsCore->previousTransformations.rotation = graphicsCore->transformations.rotation;
+			graphicsCore->previousTransformations.valid = true;
+		}
+	}
+}
+
+void VulkanBase::captureRenderSnapshot()
+{
+	auto& snapshot = m_renderSnapshots[1 - m_drawnSnapshot];
+	snapshot.items.clear();
+
+	const float alpha = static_cast<float>(App::time.interpolationAlpha());
+	for (const auto& graphicsCore : m_activeGraphicsComponentCores)
+	{
+		if (!graphicsCore->active)
+			continue;
+
+		RenderItem item;
+		item.modelData = &graphicsCore->modelData;
+		item.position = graphicsCore->transformations.position;
+		item.rotation = graphicsCore->transformations.rotation;
+		item.size = graphicsCore->transformations.size;
+		item.tint = graphicsCore->shaderInfo.tint;
+		item.transparency = graphicsCore->shaderInfo.transparency;
+
+		if (graphicsCore->interpolate && graphicsCore->previousTransformations.valid)
+		{
+			const auto& previous = graphicsCore->previousTransformations;
+			// go shorter way around
+			glm::vec3 rotationDelta = item.rotation - previous.rotation;
+			rotationDelta -= glm::two_pi<float>() * glm::round(rotationDelta / glm::two_pi<float>());
+
+			item.position = glm::mix(previous.position, item.position, alpha);
+			item.rotation = previous.rotation + rotationDelta * alpha;
+		}
+
+		snapshot.items.push_back(item);
+	}
+
+	for (auto& instancedModel : m_instancedModels)
+	{
+		for (const auto& instance : instancedModel.instances)
+		{
+			RenderItem item;
+			item.modelData = &instancedModel.modelData;
+			item.position = instance.position;
+			item.rotation = instance.rotation;
+			item.size = instance.size;
+
+			snapshot.items.push_back(item);
+		}
+	}
+
+	snapshot.view = App::camera.getView();
+	snapshot.projection = App::camera.getProjection();
+
+	// those released after this point may still be in captured snapshot
+	m_releasableGraphicsComponentCores.insert(m_releasableGraphicsComponentCores.end(),
+		m_releasedGraphicsComponentCores.begin(), m_releasedGraphicsComponentCores.end());
+	m_releasedGraphicsComponentCores.clear();
+}
+
+void VulkanBase::swapFrame()
+{
+	for (auto& releasedCore : m_releasableGraphicsComponentCores)
+	{
+		*releasedCore = {};
+		m_graphicsComponentCores.push(releasedCore);
+	}
+	m_releasableGraphicsComponentCores.clear();
+
+	m_drawnSnapshot = 1 - m_drawnSnapshot;
+}
+
 VD::ModelData VulkanBase::getModelDataFromInfo(const Info::GraphicsComponentCreateInfo& info)
 {
 	VD::ModelData modelData;
@@ -327,43 +454,13 @@ void VulkanBase::initUI()
 	instance.initUI(this);
 }
 
-void VulkanBase::mainLoop()
+void VulkanBase::renderFrame()
 {
-	{
-		std::lock_guard updateWaitLock(GlobalSynchronizaion::graphics.notifyMutex);
+	std::lock_guard renderLock(m_renderMutex);
 
-		GlobalSynchronizaion::graphics.initialized.store(true);
-		GlobalSynchronizaion::main_cv.notify_one();
-	}
-
-	while (GlobalSynchronizaion::shouldStopEngine == false)
-	{
-		{
-			//std::cout << "G wait\n";
-			std::unique_lock updateWaitLock(GlobalSynchronizaion::graphics.updateWaitMutex);
-
-			auto waitPred = [] { return GlobalSynchronizaion::graphics.update.load(); };
-			while(!waitPred())
-				GlobalSynchronizaion::thread_cv.wait(updateWaitLock);
-
-			GlobalSynchronizaion::graphics.update.store(false);
-		}
-		//std::cout << "Started graphics loop\n";
-
-		prepareFrame();
-		drawFrame();
-		processInput();
-
-		{
-			std::lock_guard updateWaitLock(GlobalSynchronizaion::graphics.notifyMutex);
-			//std::cout << "Graphics about to notify\n";
-
-			GlobalSynchronizaion::graphics.updated.store(true);
-			GlobalSynchronizaion::main_cv.notify_one();
-		}
-	}
-
-	vkDeviceWaitIdle(m_device);
+	prepareFrame();
+	drawFrame();
+	processInput();
 }
 
 void VulkanBase::createInstance()
@@ -862,29 +959,31 @@ void VulkanBase::createPushRanges()
 
 void VulkanBase::updateUniformBufferOffsets()
 {
-	auto strideSize = 
-		getRequiredAligment(sizeof(UniformBufferObject), m_device.properties.limits.minUniformBufferOffsetAlignment);
+	auto& snapshot = m_renderSnapshots[m_drawnSnapshot];
+	const auto strideSize = getUniformStride();
 	size_t totalBytes = 0;
 	
-	for (auto& graphicsCore : m_activeGraphicsComponentCores)
-		totalBytes = graphicsCore->modelData.meshDatas.size()* strideSize;
+	for (const auto& item : snapshot.items)
+		totalBytes += item.modelData->meshDatas.size() * strideSize;
 
 	// pseudo warning
 	if (m_buffers.uniform[0].size < totalBytes)
 		throw std::runtime_error("Not engough space!");
 	VkDeviceSize offset = 0;
-	for (auto& graphicsCore : m_activeGraphicsComponentCores)
+	for (auto& item : snapshot.items)
 	{
-		for (auto& meshData : graphicsCore->modelData.meshDatas)
-		{
-			meshData.dynamicBufferOffset = offset;
-			offset += strideSize;
-		}
+		item.uniformOffset = offset;
+		offset += item.modelData->meshDatas.size() * strideSize;
 	}
 
 	m_changedActiveComponentsSize = false;
 }
 
+VkDeviceSize VulkanBase::getUniformStride() const
+{
+	return getRequiredAligment(sizeof(UniformBufferObject), m_device.properties.limits.minUniformBufferOffsetAlignment);
+}
+
 void VulkanBase::createCommandBuffers()
 {
 	m_commandBuffers.resize(m_swapchain.images.size());
@@ -943,16 +1042,12 @@ void VulkanBase::recreateCommandBuffer(uint32_t currentImage)
 	uint32_t descriptorOffsets[] = { 0 };
 
 	// update constants
-	m_pushConstants.projection = App::camera.getProjection();
-	m_pushConstants.view = App::camera.getView();
+	const auto& snapshot = m_renderSnapshots[m_drawnSnapshot];
+	m_pushConstants.projection = snapshot.projection;
+	m_pushConstants.view = snapshot.view;
 
-	for (const auto& graphicsCore : m_activeGraphicsComponentCores)
-	{
-		if (graphicsCore->active)
-		{
-			drawModelData(graphicsCore->modelData, cmdBuffer, currentImage);
-		}
-	}
+	for (const auto& item : snapshot.items)
+		drawModelData(*item.modelData, item.uniformOffset, cmdBuffer, currentImage);
 	// drawUI
 	UI::getInstance().drawUI(cmdBuffer);
 	vkCmdEndRenderPass(cmdBuffer);
@@ -963,8 +1058,10 @@ void VulkanBase::recreateCommandBuffer(uint32_t currentImage)
 	}
 }
 
-void VulkanBase::drawModelData(const VD::ModelData& modelData, VkCommandBuffer& cmdBuff, uint32_t currentImage)
+void VulkanBase::drawModelData(const VD::ModelData& modelData, VkDeviceSize uniformOffset, VkCommandBuffer& cmdBuff, uint32_t currentImage)
 {
+	const auto strideSize = getUniformStride();
+
 	VD::Pipeline* currentPipeline = nullptr;
 	vkh::structs::Buffer* currentVertexBuffer = nullptr;
 	vkh::structs::Buffer* currentIndexBuffer = nullptr;
@@ -974,8 +1071,9 @@ void VulkanBase::drawModelData(const VD::ModelData& modelData, VkCommandBuffer&
 	size_t indexOffset = 0;
 	size_t indexCount = 0;
 
-	for (const auto& meshData : modelData.meshDatas)
+	for (uint32_t meshIndex = 0; meshIndex < modelData.meshDatas.size(); ++meshIndex)
 	{
+		const auto& meshData = modelData.meshDatas[meshIndex];
 		if (&(*meshData.pipeline) != currentPipeline)
 		{
 			currentPipeline = &(*meshData.pipeline);
@@ -1012,7 +1110,7 @@ void VulkanBase::drawModelData(const VD::ModelData& modelData, VkCommandBuffer&
 			}
 		}
 		VkDescriptorSet descriptorSets[] = { meshData.descriptorSet->sets[currentImage] };
-		uint32_t offsets[] = { meshData.dynamicBufferOffset };
+		uint32_t offsets[] = { static_cast<uint32_t>(uniformOffset + meshIndex * strideSize) };
 		vkCmdBindDescriptorSets(cmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, currentPipeline->pipelineLayout, 0,
 			1, descriptorSets, 1, offsets);
 
@@ -1135,46 +1233,46 @@ void VulkanBase::updateUniformBuffer(uint32_t currentImage)
 	std::chrono::time_point currentTime = std::chrono::high_resolution_clock::now();
 	float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-	const VkDeviceSize dynamicAligment = getRequiredAligment(sizeof(UniformBufferObject), 256);
+	const auto strideSize = getUniformStride();
 	uint8_t* const data = static_cast<uint8_t* const>(m_buffers.uniform[currentImage].map());
 
-	int count = 0;
-	for (const auto& graphicsCore : m_activeGraphicsComponentCores)
-	{
-		if (graphicsCore->active)
+	// interpolated already when captured, every item writes only its own offsets
+	const auto& snapshot = m_renderSnapshots[m_drawnSnapshot];
+	App::jobSystem.parallelFor(static_cast<uint32_t>(snapshot.items.size()), [&](uint32_t begin, uint32_t end)
 		{
-			for (const auto& meshData : graphicsCore->modelData.meshDatas)
+			for (uint32_t index = begin; index < end; ++index)
 			{
-				UniformBufferObject ubo;
-				auto model = glm::mat4(1.0);
-				const auto& [position, rotation, size] = graphicsCore->transformations;
-
-				model = glm::translate(model, position);
-				model = glm::rotate(model, rotation.x, (glm::vec3)Transformations::VectorUp);
-				model = glm::rotate(model, rotation.y, (glm::vec3)Transformations::VectorRight);
-				model = glm::rotate(model, rotation.z, (glm::vec3)Transformations::VectorForward);
-				model = glm::scale(model, size);
-				ubo.model = model;
-				ubo.shaderDrawInfo.tint = graphicsCore->shaderInfo.tint;
-				ubo.shaderDrawInfo.transparency = graphicsCore->shaderInfo.transparency;
-
-				memcpy(data + meshData.dynamicBufferOffset, &ubo, dynamicAligment);
+				const auto& item = snapshot.items[index];
+				const auto& position = item.position;
+				const auto& rotation = item.rotation;
+				const auto& size = item.size;
+
+				// same transformation for every mesh of item
+				for (uint32_t meshIndex = 0; meshIndex < item.modelData->meshDatas.size(); ++meshIndex)
+				{
+					UniformBufferObject ubo;
+					auto model = glm::mat4(1.0);
+
+					model = glm::translate(model, position);
+					model = glm::rotate(model, rotation.x, (glm::vec3)Transformations::VectorUp);
+					model = glm::rotate(model, rotation.y, (glm::vec3)Transformations::VectorRight);
+					model = glm::rotate(model, rotation.z, (glm::vec3)Transformations::VectorForward);
+					model = glm::scale(model, size);
+					ubo.model = model;
+					ubo.shaderDrawInfo.tint = item.tint;
+					ubo.shaderDrawInfo.transparency = item.transparency;
+
+					memcpy(data + item.uniformOffset + meshIndex * strideSize, &ubo, sizeof(ubo));
+				}
 			}
-		}
-
-	}
+		});
 	m_buffers.uniform[currentImage].unmap();
 }
 
 
 void VulkanBase::cleanUp()
 {
-	{
-		std::unique_lock cleanUpWaitLock(GlobalSynchronizaion::graphics.cleanupWaitMutex);
-
-		GlobalSynchronizaion::thread_cv.wait(cleanUpWaitLock, [] { return GlobalSynchronizaion::graphics.cleanUp.load(); });
-		GlobalSynchronizaion::graphics.cleanUp.store(false);
-	}
+	vkDeviceWaitIdle(m_device);
 
 	UI::getInstance().destroyUI();
 	cleanUpSwapchain();
@@ -1199,13 +1297,6 @@ void VulkanBase::cleanUp()
 	vkDestroyInstance(m_instance, nullptr);
 
 	glfwTerminate();
-
-	{
-		std::lock_guard notifyLock(GlobalSynchronizaion::graphics.cleanupWaitMutex);
-
-		GlobalSynchronizaion::graphics.cleanedUp.store(true);
-		GlobalSynchronizaion::main_cv.notify_one();
-	}
 }
 
 void VulkanBase::cleanUpSwapchain()
@@ -1229,6 +1320,10 @@ void VulkanBase::cleanUpBuffers()
 void VulkanBase::cleanUpGraphicsComponentCores()
 {
 	m_activeGraphicsComponentCores = {};
+	m_releasedGraphicsComponentCores = {};
+	m_releasableGraphicsComponentCores = {};
+	m_renderSnapshots = {};
+	m_instancedModels = {};
 	m_graphicsComponentCores = {};
 	delete[] m_graphicsComponentCoresData;
 }
@@ -7,6 +7,7 @@
 #include <stack>
 #include <optional>
 #include <map>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 
@@ -131,13 +132,51 @@ private:
 		std::vector<vkh::structs::Buffer> uniform;
 	} m_buffers;
 
+	// state graphics thread draws, so main can change cores meanwhile
+	struct RenderItem
+	{
+		VD::ModelData* modelData = nullptr;
+		glm::vec3 position = {};
+		glm::vec3 rotation = {};
+		glm::vec3 size = {};
+		glm::vec4 tint = {};
+		float transparency = 0;
+		// meshes follow by uniform stride, so items can share model data
+		VkDeviceSize uniformOffset = 0;
+	};
+	struct RenderSnapshot
+	{
+		std::vector<RenderItem> items;
+		glm::mat4 view = glm::mat4(1.0);
+		glm::mat4 projection = glm::mat4(1.0);
+	};
+	std::array<RenderSnapshot, 2> m_renderSnapshots;
+	uint32_t m_drawnSnapshot = 0;
+	// model data and resource managers are shared with main thread
+	mutable std::mutex m_renderMutex;
+
 	// helperFunctions
 	friend void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 	std::vector<const char*> getRequiredExtensions() const;
 	bool checkValidationLayerSupport() const;
 	std::vector<char> readFile(const char* fileName);
 public:
-	void run();
+	// one copy of instanced model, transformations are final
+	struct ModelInstance
+	{
+		glm::vec3 position = {};
+		glm::vec3 rotation = {};
+		glm::vec3 size = { 1.0, 1.0, 1.0 };
+	};
+
+	void initialize();
+	// draws last swapped snapshot, runs as job next to simulation
+	void renderFrame();
+	void cleanUp();
+	// only component pools, no window nor device
+	void initHeadless();
+	void cleanUpHeadless();
+	bool isHeadless() const;
 
 	vkh::structs::VulkanDevice* getDevice();
 	vkh::structs::Swapchain& getSwapchain();
@@ -150,18 +189,40 @@ public:
 
 
 	bool updatePhysics;
+	bool m_headless = false;
 	GraphicsComponentCore* m_graphicsComponentCoresData;
 	uint32_t m_graphicsComponentCoreCount;
 	std::stack<GraphicsComponentCore*>  m_graphicsComponentCores;
 
 	bool m_changedActiveComponentsSize = false;
 	std::vector<GraphicsComponentCore*> m_activeGraphicsComponentCores;
+	// drawn snapshot may still point to them, so they go back to pool on frame swap
+	std::vector<GraphicsComponentCore*> m_releasedGraphicsComponentCores;
+	std::vector<GraphicsComponentCore*> m_releasableGraphicsComponentCores;
+
+	struct InstancedModel
+	{
+		VD::ModelData modelData;
+		std::vector<ModelInstance> instances;
+	};
+	// deque so render items can point to model data
+	std::deque<InstancedModel> m_instancedModels;
 
 	pGraphicsComponentCore createGrahicsComponentCore();
 	void updateGrahicsComponentCore(pGraphicsComponentCore& graphicsCore, const Info::GraphicsComponentCreateInfo& info);
 	void copyGraphicsComponentCore(const pGraphicsComponentCore& copyGraphicsCore, pGraphicsComponentCore& destinationGraphicsCore) const;
 	pGraphicsComponentCore copyCreateGraphicsComponentCore(const pGraphicsComponentCore& copyGraphicsCore);
 	void deactivateGraphicsComponentCore(pGraphicsComponentCore& deactivateCore);
+	// model drawn many times without component per copy
+	uint32_t createInstancedModel(const Info::GraphicsComponentCreateInfo& info);
+	// main thread, taken on next snapshot capture
+	void setModelInstances(uint32_t instancedModel, const std::vector<ModelInstance>& instances);
+	// call before each simulation step
+	void storePreviousTransformations();
+	// main thread, may run while previous snapshot is being drawn
+	void captureRenderSnapshot();
+	// main thread, render job must not run
+	void swapFrame();
 
 private:
 	VD::ModelData getModelDataFromInfo(const Info::GraphicsComponentCreateInfo& info);
@@ -172,7 +233,6 @@ private:
 	void initModules();
 	void initGraphicsComponentCores();
 	void initUI();
-	void mainLoop();
 	// Foundation
 	// create instance
 	void createInstance();
@@ -213,13 +273,14 @@ private:
 	//
 
 	void updateUniformBufferOffsets();
+	VkDeviceSize getUniformStride() const;
 
 	void createTextureSampler();
 	//drawing
 
 	void createCommandBuffers();
 	void recreateCommandBuffer(uint32_t currentImage);
-	void drawModelData(const VD::ModelData& modelData, VkCommandBuffer& cmdBuff, uint32_t currentImage);
+	void drawModelData(const VD::ModelData& modelData, VkDeviceSize uniformOffset, VkCommandBuffer& cmdBuff, uint32_t currentImage);
 
 	void createSyncObjects();
 
@@ -227,7 +288,6 @@ private:
 	void drawFrame();
 	void updateUniformBuffer(uint32_t currentImage);
 	// clear
-	void cleanUp();
 	void cleanUpSwapchain();
 	void cleanUpBuffers();
 	void cleanUpGraphicsComponentCores();
@@ -141,8 +141,6 @@ namespace VulkanData
 		vkh::structs::Buffer* indexBuffer = nullptr;
 		SharedDescriptorSet descriptorSet;
 		SharedPipeline pipeline = {};
-
-		size_t dynamicBufferOffset = 0;
 	};
 
 
@@ -3,7 +3,6 @@
 #include <GLFW/glfw3.h>
 
 #include "GlobalObjects.h"
-#include "GlobalSynchronization.h"
 
 void Window::windowResizeCallback(GLFWwindow* pWindow, int x, int y)
 {
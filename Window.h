@@ -43,7 +43,7 @@ public:
 	void hideCursor();
 	void disableCursor();
 private:
-	friend int main();
+	friend int main(int argc, char* argv[]);
 
 	void initialize(std::string windowName);
 	void cleanup();
@@ -1,31 +1,288 @@
 #include "VulkanBase.h"
 #include <iostream>
-#include <future>
 #include "GlobalObjects.h"
-#include "GlobalSynchronization.h"
 #include "SimulationArea.h"
 
 #include <boost/geometry.hpp>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
 
 constexpr const char* AppName = "Traffic Simulation";
 
-void runGraphics()
+struct LaunchOptions
 {
-	try
+	// no window, no vulkan, just simulation and physics
+	bool headless = false;
+	uint32_t ticks = 3'000;
+	uint32_t gridSize = 4;
+	float blockLength = 100.0f;
+	// route queries compared before ticks, 0 skips it
+	uint32_t routeQueries = 0;
+	// boxes moved through both broadphases before ticks, 0 skips it
+	uint32_t benchmarkColliders = 0;
+	Physics::BroadPhase broadPhase = Physics::BroadPhase::GRID;
+};
+
+LaunchOptions parseLaunchOptions(int argc, char* argv[])
+{
+	LaunchOptions options;
+	for (int index = 1; index < argc; ++index)
 	{
-		App::vulkanBase.run();
+		auto nextValue = [&]() -> std::string
+		{
+			if (index + 1 >= argc)
+				throw std::runtime_error(std::string("Missing value for ") + argv[index]);
+
+			return argv[++index];
+		};
+
+		if (std::strcmp(argv[index], "--headless") == 0)
+			options.headless = true;
+		else if (std::strcmp(argv[index], "--ticks") == 0)
+			options.ticks = std::stoul(nextValue());
+		else if (std::strcmp(argv[index], "--grid") == 0)
+			options.gridSize = std::stoul(nextValue());
+		else if (std::strcmp(argv[index], "--block") == 0)
+			options.blockLength = std::stof(nextValue());
+		else if (std::strcmp(argv[index], "--route-queries") == 0)
+			options.routeQueries = std::stoul(nextValue());
+		else if (std::strcmp(argv[index], "--colliders") == 0)
+			options.benchmarkColliders = std::stoul(nextValue());
+		else if (std::strcmp(argv[index], "--broadphase") == 0)
+		{
+			const auto broadPhase = nextValue();
+			if (broadPhase == "grid")
+				options.broadPhase = Physics::BroadPhase::GRID;
+			else if (broadPhase == "sap")
+				options.broadPhase = Physics::BroadPhase::SWEEP_AND_PRUNE;
+			else
+				throw std::runtime_error("Unknown broadphase " + broadPhase);
+		}
+		else
+			throw std::runtime_error(std::string("Unknown option ") + argv[index]);
 	}
-	catch (const std::exception & exc)
+
+	return options;
+}
+
+// same random lane pairs through Dijkstra, A* and contraction hierarchy
+void runRouteBenchmark(uint32_t queryCount)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const auto& laneGraph = App::laneGraph;
+	if (laneGraph.getLaneCount() == 0 || queryCount == 0)
 	{
-		std::cout << exc.what() << std::endl;
+		std::cout << "No lanes to route on\n";
+		return;
+	}
+
+	RouteHierarchy routeHierarchy;
+	const auto buildStart = Clock::now();
+	routeHierarchy.build(laneGraph);
+	const std::chrono::duration<double> buildTime = Clock::now() - buildStart;
+
+	std::mt19937 engine(queryCount);
+	std::uniform_int_distribution<LaneId> randomLane(0, laneGraph.getLaneCount() - 1);
+	std::vector<std::pair<LaneId, LaneId>> queries(queryCount);
+	for (auto& [startLane, endLane] : queries)
+	{
+		startLane = randomLane(engine);
+		endLane = randomLane(engine);
 	}
+
+	auto routeTravelTime = [&](const PathFinding::TravellSegments& travellSegments)
+	{
+		float travelTime = 0.0f;
+		for (const auto& travellSegment : travellSegments)
+		{
+			travelTime += laneGraph.getTravelTime(travellSegment.exitLane());
+			if (travellSegment.switchLane != invalidLaneId)
+				travelTime += Settings::PathFinding::laneSwitchPenalty;
+		}
+
+		return travelTime;
+	};
+	// microseconds per query
+	auto measure = [&](auto&& findRoute, std::vector<float>& travelTimes)
+	{
+		travelTimes.clear();
+		const auto start = Clock::now();
+		for (const auto& [startLane, endLane] : queries)
+			travelTimes.push_back(routeTravelTime(findRoute(startLane, endLane)));
+		const std::chrono::duration<double, std::micro> time = Clock::now() - start;
+
+		return time.count() / queries.size();
+	};
+
+	std::vector<float> dijkstraTimes, aStarTimes, hierarchyTimes;
+	const double dijkstraQuery = measure([&](LaneId startLane, LaneId endLane)
+		{ return PathFinding::findRoute(laneGraph, startLane, endLane, false); }, dijkstraTimes);
+	const double aStarQuery = measure([&](LaneId startLane, LaneId endLane)
+		{ return PathFinding::findRoute(laneGraph, startLane, endLane); }, aStarTimes);
+	const double hierarchyQuery = measure([&](LaneId startLane, LaneId endLane)
+		{ return routeHierarchy.findRoute(laneGraph, startLane, endLane); }, hierarchyTimes);
+
+	// routes may differ on ties, travel times may not
+	auto countMismatches = [&](const std::vector<float>& travelTimes)
+	{
+		uint32_t mismatches = 0;
+		for (uint32_t index = 0; index < travelTimes.size(); ++index)
+		{
+			if (std::abs(travelTimes[index] - dijkstraTimes[index]) > 1e-3f * std::max(1.0f, dijkstraTimes[index]))
+				++mismatches;
+		}
+
+		return mismatches;
+	};
+
+	std::cout << "Route benchmark\n"
+		<< "lanes: " << laneGraph.getLaneCount() << '\n'
+		<< "queries: " << queryCount << '\n'
+		<< "hierarchy build: " << buildTime.count() << " s\n"
+		<< "hierarchy shortcuts: " << routeHierarchy.getShortcutCount() << '\n'
+		<< "hierarchy memory: " << routeHierarchy.getMemoryUsage() / 1024 << " KiB\n"
+		<< "dijkstra query: " << dijkstraQuery << " us\n"
+		<< "a* query: " << aStarQuery << " us, mismatches " << countMismatches(aStarTimes) << '\n'
+		<< "hierarchy query: " << hierarchyQuery << " us, mismatches " << countMismatches(hierarchyTimes) << std::endl;
+}
+
+// boxes wander over area and look for each other, same moves go through grid and sweep and prune
+void runBroadPhaseBenchmark(uint32_t colliderCount, uint32_t ticks, float areaSize)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	// about car sized, detector reaches to cars around
+	constexpr float halfLength = 1.5f;
+	constexpr float halfWidth = 1.0f;
+	constexpr float detectorReach = 10.0f;
+	constexpr float maxSpeed = 15.0f;
+
+	auto createBox = [](float boxHalfLength, float boxHalfWidth)
+	{
+		return Points{
+			Point(-boxHalfLength, 0.0f, -boxHalfWidth),
+			Point(-boxHalfLength, 0.0f, boxHalfWidth),
+			Point(boxHalfLength, 0.0f, boxHalfWidth),
+			Point(boxHalfLength, 0.0f, -boxHalfWidth),
+		};
+	};
+	const uint32_t tag = App::physics.getTagFlag("BENCHMARK");
+	const uint32_t detectorSlot = App::physics.getColliderSlot("DETECTOR");
+	const float deltaTime = static_cast<float>(App::time.fixedDeltaTime());
+	const auto previousBroadPhase = App::physics.getBroadPhase();
+
+	struct Result
+	{
+		double frameTime = 0.0;
+		uint64_t testedPairs = 0;
+		uint64_t acceptedPairs = 0;
+	};
+	auto measure = [&](Physics::BroadPhase broadPhase)
+	{
+		std::mt19937 engine(colliderCount);
+		std::uniform_real_distribution<float> randomCoordinate(-areaSize / 2.0f, areaSize / 2.0f);
+		std::uniform_real_distribution<float> randomVelocity(-maxSpeed, maxSpeed);
+
+		std::vector<pPhysicsComponentCore> cores(colliderCount);
+		std::vector<glm::vec3> positions(colliderCount);
+		std::vector<glm::vec3> velocities(colliderCount);
+		for (uint32_t index = 0; index < colliderCount; ++index)
+		{
+			auto& core = cores[index];
+			core = App::physics.createPhysicsComponentCore();
+			core->active = true;
+			core->usedSlots = (1 << ColliderSlots::body) | (1 << detectorSlot);
+			core->colliders[ColliderSlots::body].setBoundaries(createBox(halfLength, halfWidth));
+			core->colliders[ColliderSlots::body].setSelfTags(tag);
+			core->colliders[detectorSlot].setBoundaries(createBox(halfLength + detectorReach, halfWidth + detectorReach));
+			core->colliders[detectorSlot].setOtherTags(tag);
+
+			positions[index] = glm::vec3(randomCoordinate(engine), 0.0f, randomCoordinate(engine));
+			velocities[index] = glm::vec3(randomVelocity(engine), 0.0f, randomVelocity(engine));
+		}
+
+		Result result;
+		auto addStatistics = [&]()
+		{
+			const auto statistics = App::physics.getStatistics();
+			result.testedPairs += statistics.testedPairs;
+			result.acceptedPairs += statistics.acceptedPairs;
+		};
+
+		App::physics.setBroadPhase(broadPhase);
+		for (uint32_t tick = 0; tick < ticks; ++tick)
+		{
+			for (uint32_t index = 0; index < colliderCount; ++index)
+			{
+				auto& position = positions[index];
+				auto& velocity = velocities[index];
+				position += velocity * deltaTime;
+				// bounce off area edges
+				for (auto axis : { 0, 2 })
+				{
+					if (std::abs(position[axis]) > areaSize / 2.0f)
+						velocity[axis] = -velocity[axis];
+				}
+
+				cores[index]->setPosition(position);
+				cores[index]->setRotation(glm::vec3(std::atan2(velocity.z, velocity.x), 0.0f, 0.0f));
+			}
+
+			const auto start = Clock::now();
+			App::physics.swapFrame();
+			App::physics.updateCollisions();
+			result.frameTime += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+			// published ones are of previous frame
+			if (tick > 0)
+				addStatistics();
+		}
+
+		for (auto& core : cores)
+			App::physics.deactivatePhysicsComponentCore(core);
+		// publishes last frame and gives cores back
+		App::physics.swapFrame();
+		addStatistics();
+
+		result.frameTime /= std::max(ticks, 1u);
+		return result;
+	};
+
+	const auto grid = measure(Physics::BroadPhase::GRID);
+	const auto sweepAndPrune = measure(Physics::BroadPhase::SWEEP_AND_PRUNE);
+	App::physics.setBroadPhase(previousBroadPhase);
+
+	std::cout << "Broadphase benchmark\n"
+		<< "colliders: " << colliderCount << " with detectors\n"
+		<< "ticks: " << ticks << '\n'
+		<< "grid frame: " << grid.frameTime << " ms, tested pairs " << grid.testedPairs << ", accepted pairs " << grid.acceptedPairs << '\n'
+		<< "sweep and prune frame: " << sweepAndPrune.frameTime << " ms, tested pairs " << sweepAndPrune.testedPairs
+		<< ", accepted pairs " << sweepAndPrune.acceptedPairs << std::endl;
 }
 
-void runPhysics()
+// collisions of last swapped snapshot
+JobCounter physicsCounter;
+// drawing of last swapped render snapshot
+JobCounter renderCounter;
+
+// physics works on snapshot of previous step meanwhile simulation consumes its last results
+void stepSimulation()
+{
+	App::jobSystem.wait(physicsCounter);
+	App::physics.swapFrame();
+	App::jobSystem.submitBackground([] { App::physics.updateCollisions(); }, physicsCounter);
+
+	App::vulkanBase.storePreviousTransformations();
+	App::simulation.updateSimulation();
+}
+
+// last jobs may still be running, their exceptions come only now
+void finishJobs(JobCounter& counter)
 {
 	try
 	{
-		App::physics.run();
+		App::jobSystem.wait(counter);
 	}
 	catch (const std::exception & exc)
 	{
@@ -33,118 +290,183 @@ void runPhysics()
 	}
 }
 
-int main()
+int main(int argc, char* argv[])
 {
 	//throw std::runtime_error("Pri vymazani treaba vymazat aj zo vsetkych cast, lebo DescrutporSet sa preplnuje!");
 	std::ios_base::sync_with_stdio(false);
-	// experimental, might be unstable
-
-	std::thread graphicsThread;
-	std::thread physicsThread;
-	//std::thread windowThread;
 
+	LaunchOptions options;
+	try
 	{
-		App::window.initialize(AppName);
+		options = parseLaunchOptions(argc, argv);
 	}
+	catch (const std::exception & exc)
 	{
-		std::mutex initializationMutex;
-		std::unique_lock initializationLock(initializationMutex);
+		std::cout << exc.what() << std::endl;
+		return 1;
+	}
 
+	if (options.headless)
+	{
+		App::jobSystem.initialize();
+		// graphics components only take cores from pool
+		App::vulkanBase.initHeadless();
+		App::physics.initialize();
+		App::physics.setBroadPhase(options.broadPhase);
+		App::vehicleEngine.initialize();
+
+		try
 		{
-			GlobalSynchronizaion::graphics.initialized.store(false);
-			graphicsThread = std::thread(runGraphics);
-			GlobalSynchronizaion::main_cv.wait(initializationLock, [] { return GlobalSynchronizaion::graphics.initialized.load(); });
-		}
+			App::time.tick();
+			SimulationArea simulationArea;
+			simulationArea.initArea();
+			simulationArea.m_objectManager.buildGridNetwork(options.gridSize, options.blockLength);
+			simulationArea.setSimualtionMode(SimulationArea::SimulationMode::RUN);
+
+			try
+			{
+				if (options.routeQueries)
+					runRouteBenchmark(options.routeQueries);
+				if (options.benchmarkColliders)
+					runBroadPhaseBenchmark(options.benchmarkColliders, options.ticks, options.gridSize * options.blockLength);
+
+				uint64_t testedPairs = 0;
+				uint64_t acceptedPairs = 0;
+				// ticks while replanning runs on workers and others, rerouting may not slow them
+				struct TickTimes
+				{
+					uint32_t count = 0;
+					double total = 0.0;
+					double longest = 0.0;
+
+					double average() const { return count ? total / count : 0.0; }
+				} reroutingTicks, otherTicks;
+				const auto startTime = std::chrono::high_resolution_clock::now();
+
+				for (uint32_t tick = 0; tick < options.ticks; ++tick)
+				{
+					auto& tickTimes = App::vehicleEngine.isRerouting() ? reroutingTicks : otherTicks;
+					const auto tickStart = std::chrono::high_resolution_clock::now();
+
+					// no accumulator, steps go as fast as they can
+					App::time.advanceSimulation();
+					stepSimulation();
+
+					const std::chrono::duration<double, std::milli> tickTime = std::chrono::high_resolution_clock::now() - tickStart;
+					++tickTimes.count;
+					tickTimes.total += tickTime.count();
+					tickTimes.longest = std::max(tickTimes.longest, tickTime.count());
+
+					const auto statistics = App::physics.getStatistics();
+					testedPairs += statistics.testedPairs;
+					acceptedPairs += statistics.acceptedPairs;
+				}
+
+				const std::chrono::duration<double> wallTime = std::chrono::high_resolution_clock::now() - startTime;
+				std::cout << "Headless run finished\n"
+					<< "ticks: " << options.ticks << '\n'
+					<< "broadphase: " << (options.broadPhase == Physics::BroadPhase::GRID ? "grid" : "sweep and prune") << '\n'
+					<< "simulated time: " << App::time.simulationTime() << " s\n"
+					<< "wall time: " << wallTime.count() << " s\n"
+					<< "ticks per second: " << (wallTime.count() > 0.0 ? options.ticks / wallTime.count() : 0.0) << '\n'
+					<< "tested pairs: " << testedPairs << '\n'
+					<< "accepted pairs: " << acceptedPairs << '\n'
+					<< "vehicles left: " << App::vehicleEngine.getVehicleCount() << '\n'
+					<< "tick while rerouting: " << reroutingTicks.average() << " ms, longest " << reroutingTicks.longest << " ms, ticks " << reroutingTicks.count << '\n'
+					<< "tick otherwise: " << otherTicks.average() << " ms, longest " << otherTicks.longest << " ms, ticks " << otherTicks.count << std::endl;
+
+				// noise of single tick aside, average may not grow much
+				constexpr double allowedSlowdown = 1.5;
+				if (reroutingTicks.count && otherTicks.count && reroutingTicks.average() > otherTicks.average() * allowedSlowdown)
+					std::cout << "Rerouting slows simulation ticks down" << std::endl;
+			}
+			catch (const std::exception & exc)
+			{
+				std::cout << exc.what() << std::endl;
+			}
 
+			// collisions read objects of area, so they finish before it goes away
+			finishJobs(physicsCounter);
+		}
+		catch (const std::exception & exc)
 		{
-			GlobalSynchronizaion::physics.initialized.store(false);
-			physicsThread = std::thread(runPhysics);
-			GlobalSynchronizaion::main_cv.wait(initializationLock, [] { return GlobalSynchronizaion::physics.initialized.load(); });
+			std::cout << exc.what() << std::endl;
 		}
+
+		App::physics.cleanUp();
+		App::vulkanBase.cleanUpHeadless();
+		App::jobSystem.cleanUp();
+		return 0;
+	}
+
+	{
+		App::window.initialize(AppName);
+		App::jobSystem.initialize();
+		App::vulkanBase.initialize();
+		App::physics.initialize();
+		App::physics.setBroadPhase(options.broadPhase);
+		App::vehicleEngine.initialize();
 	}
 
+	try
 	{
 		App::time.tick();
 		SimulationArea simulationArea;
 		simulationArea.initArea();
 
-		GlobalSynchronizaion::shouldStopEngine = false;
-		while (GlobalSynchronizaion::shouldStopEngine == false)
+		try
 		{
-			//std::cout << "New loop\n";
-			App::time.tick();
-
-			// update wndow for curent frame
-			{
-				App::window.updateFrame();
-				App::camera.update();
-			}
-			// should before update, because they rely on this
-			GlobalSynchronizaion::shouldStopEngine = App::window.isClosed();
-			// update graphics and physics
+			while (!App::window.isClosed())
 			{
-				std::mutex updateMutex;
-				std::unique_lock updateLock(updateMutex);
+				//std::cout << "New loop\n";
+				App::time.tick();
 
-				// reset
+				// update wndow for curent frame
 				{
-					GlobalSynchronizaion::graphics.update.store(true);
-					GlobalSynchronizaion::graphics.updated.store(false);
+					App::window.updateFrame();
+					App::camera.update();
+					App::input.update();
+				}
 
-					GlobalSynchronizaion::physics.update.store(true);
-					GlobalSynchronizaion::physics.updated.store(false);
+				// simulation goes by fixed steps, overlaps with physics and drawing of previous frame
+				while (App::time.stepSimulation())
+					stepSimulation();
 
-					GlobalSynchronizaion::thread_cv.notify_all();
-				}
-				// send and wait for signal
 				{
-					// we can update input meantime
-					{
-						App::input.update();
-					}
-					//std::cout << "Started all wait.. \n";
-					auto wait = [] {
-						return	!GlobalSynchronizaion::graphics.updated.load() ||
-							!GlobalSynchronizaion::physics.updated.load();
-					};
-
-					while (wait())
-						std::this_thread::sleep_for(std::chrono::nanoseconds(10));
+					simulationArea.update();
 				}
-			}
 
+				// drawing of previous frame may still go on while capturing
+				App::vehicleEngine.publishInstances();
+				App::vulkanBase.captureRenderSnapshot();
+				{
+					App::jobSystem.wait(renderCounter);
 
-			// update UI
-			{
-				UI::getInstance().updateDrawData();
-			}
+					// nothing is drawn now, safe to touch what render job uses
+					App::vulkanBase.swapFrame();
+					UI::getInstance().updateDrawData();
 
-			{
-				App::simulation.updateSimulation();
-				simulationArea.update();
+					App::jobSystem.submitBackground([] { App::vulkanBase.renderFrame(); }, renderCounter);
+				}
 			}
 		}
-	}
-
-	{
-		std::mutex cleanUpMutex;
-		std::unique_lock cleanUpLock(cleanUpMutex);
+		catch (const std::exception & exc)
 		{
-			GlobalSynchronizaion::graphics.cleanUp.store(true);
-			GlobalSynchronizaion::graphics.cleanedUp.store(false);
-			GlobalSynchronizaion::thread_cv.notify_all();
-			GlobalSynchronizaion::main_cv.wait(cleanUpLock, [] { return GlobalSynchronizaion::graphics.cleanedUp.load(); });
-			graphicsThread.join();
+			std::cout << exc.what() << std::endl;
 		}
 
-		{
-			GlobalSynchronizaion::physics.cleanUp.store(true);
-			GlobalSynchronizaion::physics.cleanedUp.store(false);
-			GlobalSynchronizaion::thread_cv.notify_all();
-			GlobalSynchronizaion::main_cv.wait(cleanUpLock, [] { return GlobalSynchronizaion::physics.cleanedUp.load(); });
-			physicsThread.join();
-		}
+		// render and collision jobs read objects of area, so they finish before it goes away
+		finishJobs(renderCounter);
+		finishJobs(physicsCounter);
 	}
+	catch (const std::exception & exc)
+	{
+		std::cout << exc.what() << std::endl;
+	}
+
+	App::vulkanBase.cleanUp();
+	App::physics.cleanUp();
+	App::jobSystem.cleanUp();
 
 	return 0;
 }
\ No newline at end of file